@@ -16,8 +16,10 @@
 #include "common/Exception.h"
 #include <cerrno>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <sys/un.h>
 #include <sys/stat.h>
 
@@ -197,6 +199,13 @@ bool Network::isBlocking(int sfd) {
 	}
 }
 
+void Network::setDeferAccept(int sfd, int seconds) {
+	if (setsockopt(sfd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds,
+			sizeof(seconds))) {
+		throw SystemException();
+	}
+}
+
 int Network::unixServerSocket(const char *path, SocketAddress &sa,
 		bool blocking, int type, int protocol) {
 	if (!path) {
@@ -324,6 +333,19 @@ size_t Network::receiveStream(int sockfd, unsigned char *buf, size_t length,
 	return (length - toRecv);
 }
 
+bool Network::waitForInput(int sfd, int milliseconds) {
+	pollfd pfd;
+	pfd.fd = sfd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	auto n = ::poll(&pfd, 1, milliseconds);
+	if (n == -1 && errno != EINTR) {
+		throw SystemException();
+	} else {
+		return (n > 0);
+	}
+}
+
 void Network::setReceiveTimeout(int sfd, int milliseconds) {
 	timeval to;
 	to.tv_sec = milliseconds / 1000;
@@ -76,6 +76,11 @@ public:
 	static void setBlocking(int sfd, bool block);
 	//Test whether the socket is blocking
 	static bool isBlocking(int sfd);
+	/*
+	 * Wake up the TCP listener <sfd> only after the data arrives on a new
+	 * connection (waits at most <seconds>), 0 disables.
+	 */
+	static void setDeferAccept(int sfd, int seconds);
 	//Creates a unix domain socket and binds it to the given address
 	static int unixServerSocket(const char *path, SocketAddress &sa,
 			bool blocking, int type = SOCK_STREAM, int protocol = 0);
@@ -109,6 +114,11 @@ public:
 	 */
 	static size_t receiveStream(int sockfd, unsigned char *buf, size_t length,
 			bool strict = true);
+	/*
+	 * Waits for at most <milliseconds> (negative to block forever) for the data
+	 * to arrive at the socket <sfd>. Returns true if the socket is readable.
+	 */
+	static bool waitForInput(int sfd, int milliseconds);
 	/*
 	 * Set send and receive time-outs for blocking sockets.
 	 * If the timeout value is 0 then the socket blocks forever.
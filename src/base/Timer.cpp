@@ -105,6 +105,10 @@ unsigned long long Timer::timeSeed() noexcept {
 	return Twiddler::FVN1aHash(&ts, sizeof(ts));
 }
 
+unsigned long long Timer::timeStamp() noexcept {
+	return currentTime();
+}
+
 int Timer::openTimerfd(bool blocking) {
 	auto fd = timerfd_create(CLOCK_MONOTONIC, blocking ? 0 : TFD_NONBLOCK);
 	if (fd != -1) {
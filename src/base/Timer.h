@@ -42,6 +42,8 @@ public:
 			nullptr) noexcept;
 	//Generate a 64-bit seed from current time for seeding the RNGs
 	static unsigned long long timeSeed() noexcept;
+	//Returns the current value of the monotonic clock in microseconds
+	static unsigned long long timeStamp() noexcept;
 
 	//Creates a timer file descriptor
 	static int openTimerfd(bool blocking = false);
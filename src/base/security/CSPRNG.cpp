@@ -12,8 +12,46 @@
 
 #include "CSPRNG.h"
 #include "../Storage.h"
+#include "../common/Atomic.h"
 #include "../common/Exception.h"
+#include <cstring>
+#include <openssl/crypto.h>
 #include <openssl/rand.h>
+#include <pthread.h>
+
+namespace {
+
+//Per-thread buffer of random bytes, served bytes are wiped out
+struct RandomBuffer {
+	unsigned char data[wanhive::CSPRNG::BUFFER_SIZE];
+	//Offset of the first unused byte
+	unsigned int offset;
+	//Generation of the buffered bytes
+	unsigned int generation;
+
+	~RandomBuffer() {
+		OPENSSL_cleanse(data, sizeof(data));
+	}
+};
+
+thread_local RandomBuffer buffer { { 0 }, wanhive::CSPRNG::BUFFER_SIZE, 0 };
+//Incremented on fork and reseed, invalidates the buffers
+unsigned int generation = 0;
+
+void onFork() noexcept {
+	wanhive::Atomic<>::fetchAndAdd(&generation, 1);
+}
+
+//Discards the buffered randomness in the child process
+struct ForkHandler {
+	ForkHandler() noexcept {
+		pthread_atfork(nullptr, nullptr, onFork);
+	}
+};
+
+const ForkHandler forkHandler;
+
+}  // namespace
 
 namespace wanhive {
 class CSPRNG::RandomDevice {
@@ -56,8 +94,42 @@ void CSPRNG::random(void *block, unsigned int count, bool strong) {
 	device.readData(block, count, strong);
 }
 
+bool CSPRNG::buffered(void *block, unsigned int count) noexcept {
+	if (count > BUFFER_BYPASS) {
+		return bytes(block, count);
+	}
+
+	auto current = Atomic<>::load(&generation);
+	if (buffer.generation != current) {
+		//Forked or reseeded, start over
+		OPENSSL_cleanse(buffer.data, sizeof(buffer.data));
+		buffer.offset = BUFFER_SIZE;
+		buffer.generation = current;
+	}
+
+	auto out = (unsigned char*) block;
+	while (count) {
+		if (buffer.offset == BUFFER_SIZE) {
+			if (!bytes(buffer.data, BUFFER_SIZE)) {
+				return false;
+			}
+			buffer.offset = 0;
+		}
+
+		auto n = BUFFER_SIZE - buffer.offset;
+		n = (count < n) ? count : n;
+		memcpy(out, buffer.data + buffer.offset, n);
+		OPENSSL_cleanse(buffer.data + buffer.offset, n);
+		buffer.offset += n;
+		out += n;
+		count -= n;
+	}
+	return true;
+}
+
 bool CSPRNG::seed(const void *buf, int count) noexcept {
 	RAND_seed(buf, count);
+	onFork();
 	return (RAND_status() == 1);
 }
 
@@ -25,9 +25,17 @@ public:
 	 * Returns true on success, false otherwise
 	 */
 	static bool bytes(void *block, unsigned int count) noexcept;
+	/*
+	 * Same as above, but the small requests are served from a per-thread
+	 * buffer which is refilled from libcrypto's CSPRNG in large batches. The
+	 * buffer is discarded after a fork and after the CSPRNG is reseeded.
+	 * Returns true on success, false otherwise
+	 */
+	static bool buffered(void *block, unsigned int count) noexcept;
 	/*
 	 * Seeds libcrypto's CSPRNG with <count> bytes of random data from <buf>
 	 * Returns true if the PRNG has been seeded with enough data, falsew otherwise
+	 * Invalidates the buffered randomness of all the threads.
 	 */
 	static bool seed(const void *buf, int count) noexcept;
 	/*
@@ -35,6 +43,11 @@ public:
 	 * reads from /dev/random, otherwise /dev/urandom is used.
 	 */
 	static void random(void *block, unsigned int count, bool strong = false);
+public:
+	//Size of the per-thread buffer in bytes
+	static constexpr unsigned int BUFFER_SIZE = 4096;
+	//Requests bigger than these many bytes bypass the buffer
+	static constexpr unsigned int BUFFER_BYPASS = 256;
 private:
 	class RandomDevice;  //Forward declaration
 	static const RandomDevice device;
@@ -0,0 +1,170 @@
+/*
+ * FixedBase.cpp
+ *
+ * Fixed-base modular exponentiation
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "FixedBase.h"
+#include "../ds/Twiddler.h"
+#include <openssl/crypto.h>
+#include <cstring>
+#include <new>
+
+namespace wanhive {
+
+FixedBase::FixedBase() noexcept :
+		mont(nullptr), table(nullptr), width(0), windows(0), bits(0) {
+
+}
+
+FixedBase::~FixedBase() {
+	clear();
+}
+
+bool FixedBase::build(const BIGNUM *base, const BIGNUM *modulus,
+		unsigned int bits) noexcept {
+	clear();
+	if (!base || !modulus || !bits || !BN_is_odd(modulus)
+			|| (unsigned int) BN_num_bytes(modulus) > MAX_WIDTH) {
+		return false;
+	}
+
+	auto ctx = BN_CTX_new();
+	if (!ctx) {
+		return false;
+	}
+
+	//Whole words for a faster selection
+	width = Twiddler::align(BN_num_bytes(modulus), sizeof(uint64_t));
+	windows = (bits + WINDOW - 1) / WINDOW;
+	auto size = windows * ENTRIES;
+	auto ret = false;
+	BIGNUM *step = nullptr;
+	BIGNUM *entry = nullptr;
+	do {
+		if (!(mont = BN_MONT_CTX_new())
+				|| !BN_MONT_CTX_set(mont, modulus, ctx)) {
+			break;
+		}
+
+		if (!(table = new (std::nothrow) unsigned char[size * width])) {
+			break;
+		}
+
+		//base^(2^(WINDOW * i)) in Montgomery form
+		if (!(step = BN_new()) || !(entry = BN_new())
+				|| !BN_nnmod(step, base, modulus, ctx)
+				|| !BN_to_montgomery(step, step, mont, ctx)) {
+			break;
+		}
+
+		unsigned int index = 0;
+		for (; index < size; ++index) {
+			auto digit = index % ENTRIES;
+			if (!digit) {
+				//One in Montgomery form
+				if (!BN_one(entry) || !BN_to_montgomery(entry, entry, mont, ctx)) {
+					break;
+				}
+			} else if (!BN_mod_mul_montgomery(entry, entry, step, mont, ctx)) {
+				break;
+			}
+
+			if (BN_bn2lebinpad(entry, table + index * width, width) < 0) {
+				break;
+			}
+
+			//Move to the next window: base^(2^WINDOW * 2^(WINDOW * i))
+			if (digit == ENTRIES - 1
+					&& !BN_mod_mul_montgomery(step, entry, step, mont, ctx)) {
+				break;
+			}
+		}
+		ret = (index == size);
+	} while (0);
+
+	BN_free(entry);
+	BN_free(step);
+	BN_CTX_free(ctx);
+	if (ret) {
+		this->bits = windows * WINDOW;
+		return true;
+	} else {
+		clear();
+		return false;
+	}
+}
+
+bool FixedBase::isReady() const noexcept {
+	return table != nullptr;
+}
+
+bool FixedBase::power(BIGNUM *r, const BIGNUM *e, BN_CTX *ctx) const noexcept {
+	if (!table || !r || !e || !ctx || BN_is_negative(e)
+			|| (unsigned int) BN_num_bits(e) > bits) {
+		return false;
+	}
+
+	BN_CTX_start(ctx);
+	auto acc = BN_CTX_get(ctx);
+	auto factor = BN_CTX_get(ctx);
+	if (!factor) {
+		BN_CTX_end(ctx);
+		return false;
+	}
+
+	//Zero digits multiply by one, every window costs the same
+	alignas(uint64_t) unsigned char block[MAX_WIDTH];
+	auto ret = true;
+	for (unsigned int i = 0; ret && i < windows; ++i) {
+		unsigned int digit = 0;
+		for (unsigned int j = WINDOW; j > 0; --j) {
+			digit = (digit << 1) | BN_is_bit_set(e, i * WINDOW + j - 1);
+		}
+
+		select(i, digit, block);
+		if (!BN_lebin2bn(block, width, (i ? factor : acc))) {
+			ret = false;
+		} else if (i) {
+			ret = BN_mod_mul_montgomery(acc, acc, factor, mont, ctx);
+		}
+	}
+
+	ret = ret && BN_from_montgomery(r, acc, mont, ctx);
+	OPENSSL_cleanse(block, width);
+	BN_CTX_end(ctx);
+	return ret;
+}
+
+void FixedBase::select(unsigned int window, unsigned int digit,
+		unsigned char *block) const noexcept {
+	auto words = width / sizeof(uint64_t);
+	auto target = (uint64_t*) block;
+	auto entry = (const uint64_t*) (table + window * ENTRIES * width);
+	memset(block, 0, width);
+	for (unsigned int d = 0; d < ENTRIES; ++d, entry += words) {
+		//All ones if d equals the digit, zero otherwise (no branches)
+		auto mask = (uint64_t) 0 - (((d ^ digit) - 1) >> 31);
+		for (unsigned int k = 0; k < words; ++k) {
+			target[k] |= (entry[k] & mask);
+		}
+	}
+}
+
+void FixedBase::clear() noexcept {
+	delete[] table;
+	table = nullptr;
+	BN_MONT_CTX_free(mont);
+	mont = nullptr;
+	width = 0;
+	windows = 0;
+	bits = 0;
+}
+
+} /* namespace wanhive */
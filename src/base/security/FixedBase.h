@@ -0,0 +1,74 @@
+/*
+ * FixedBase.h
+ *
+ * Fixed-base modular exponentiation
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_BASE_SECURITY_FIXEDBASE_H_
+#define WH_BASE_SECURITY_FIXEDBASE_H_
+#include <openssl/bn.h>
+
+namespace wanhive {
+/**
+ * Modular exponentiation with a fixed base and modulus using precomputed
+ * tables (fixed window method). The table stores base^(d * 2^(w * i)) for
+ * every window <i> and digit <d> in Montgomery form, hence an exponentiation
+ * costs one Montgomery multiplication per window of the exponent and no
+ * squaring at all.
+ * Fixed-window, uniform table access: every window is processed and the
+ * entry is selected by scanning all the entries of the window, hence the
+ * table's memory access pattern doesn't depend on the exponent's digits.
+ * NOTE: Not constant time. The bignum conversion strips the leading zero
+ * limbs, the Montgomery multiplication isn't constant time, and the
+ * exponents longer than the tables' capacity are rejected.
+ * Thread safe at class level, an instance can be shared after build.
+ */
+class FixedBase {
+public:
+	FixedBase() noexcept;
+	~FixedBase();
+	/*
+	 * Builds the tables of the <base> modulo an odd <modulus> (of up to
+	 * MAX_WIDTH bytes) for the exponents of up to <bits> bits.
+	 */
+	bool build(const BIGNUM *base, const BIGNUM *modulus,
+			unsigned int bits) noexcept;
+	//Returns true if the tables are ready for use
+	bool isReady() const noexcept;
+	/*
+	 * Computes r = base^e mod modulus, returns false on error and if the
+	 * exponent is negative or larger than the tables' capacity.
+	 */
+	bool power(BIGNUM *r, const BIGNUM *e, BN_CTX *ctx) const noexcept;
+private:
+	//Copies the entry <digit> of the <window> into <block> (scans the window)
+	void select(unsigned int window, unsigned int digit,
+			unsigned char *block) const noexcept;
+	void clear() noexcept;
+public:
+	//Maximum size of the modulus in bytes
+	static constexpr unsigned int MAX_WIDTH = 1024;
+private:
+	//Window size in bits
+	static constexpr unsigned int WINDOW = 4;
+	//Entries per window (one per digit, including zero)
+	static constexpr unsigned int ENTRIES = (1 << WINDOW);
+
+	BN_MONT_CTX *mont;
+	//Fixed width, little-endian entries
+	unsigned char *table;
+	//Size of an entry in bytes
+	unsigned int width;
+	unsigned int windows;
+	unsigned int bits;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_BASE_SECURITY_FIXEDBASE_H_ */
@@ -11,8 +11,29 @@
  */
 
 #include "Srp.h"
+#include "CSPRNG.h"
 #include <cstring>
 #include <new>
+#include <openssl/crypto.h>
+
+namespace {
+
+//Loads <bits> random bits into <n> from the buffered CSPRNG
+bool randomBits(BIGNUM *n, int bits) noexcept {
+	unsigned char block[1024];
+	unsigned int bytes = (bits + 7) / 8;
+	if (bits <= 0 || bytes > sizeof(block)
+			|| !wanhive::CSPRNG::buffered(block, bytes)) {
+		return false;
+	}
+
+	block[0] &= (0xff >> (bytes * 8 - bits));
+	auto ret = BN_bin2bn(block, bytes, n) != nullptr;
+	OPENSSL_cleanse(block, bytes);
+	return ret;
+}
+
+}  // namespace
 
 namespace wanhive {
 const Srp::constants Srp::Nghex[7] = { {
@@ -144,6 +165,9 @@ const Srp::constants Srp::Nghex[7] = { {
 		"FC026E479558E4475677E9AA9E3050E2765694DFC81F56E880B96E71"
 		"60C980DD98EDD3DFFFFFFFFFFFFFFFFF", "13" } };
 
+FixedBase Srp::tables[7];
+std::once_flag Srp::precomputed[7];
+
 Srp::Srp(SrpGroup type, DigestType dType) noexcept :
 		type(type), ctx(nullptr), H(dType), status(0) {
 	memset(key.K, 0, MDSIZE);
@@ -162,10 +186,30 @@ Srp::~Srp() {
 }
 
 bool Srp::initialize() noexcept {
+	//The tables are optional
+	precompute(type);
 	return newContext() && loadPrime() && loadGenerator()
 			&& loadMultiplierParameter();
 }
 
+void Srp::reset() noexcept {
+	user.s.wipe();
+	user.x.wipe();
+	user.v.wipe();
+	secret.a.wipe();
+	secret.b.wipe();
+	shared.A.wipe();
+	shared.B.wipe();
+	shared.u.wipe();
+	key.S.wipe();
+	fake.nonce.wipe();
+	OPENSSL_cleanse(key.K, MDSIZE);
+	OPENSSL_cleanse(proof.M, MDSIZE);
+	OPENSSL_cleanse(proof.AMK, MDSIZE);
+	OPENSSL_cleanse(fake.salt, MDSIZE);
+	status = 0;
+}
+
 bool Srp::loadSalt(unsigned int bytes) noexcept {
 	if (!bytes) {
 		bytes = SALTLENGTH;
@@ -216,20 +260,20 @@ bool Srp::loadPasswordVerifier() noexcept {
 		return false;
 	}
 
-	auto n = BN_new();
+	auto n = user.v.reserve();
 	if (!n) {
 		return false;
 	}
 	//v = g^x
-	if (!BN_mod_exp(n, group.g.get(), user.x.get(), group.N.get(), ctx)) {
-		BN_clear_free(n);
+	if (!power(n, user.x.get())) {
+		user.v.wipe();
 		return false;
 	}
 
 	if (user.v.put(n)) {
 		return true;
 	} else {
-		BN_clear_free(n);
+		user.v.wipe();
 		return false;
 	}
 }
@@ -304,21 +348,21 @@ bool Srp::loadUserNonce() noexcept {
 		return false;
 	}
 
-	auto n = BN_new();
+	auto n = shared.A.reserve();
 	if (!n) {
 		return false;
 	}
 
 	//A = g^a
-	if (!BN_mod_exp(n, group.g.get(), secret.a.get(), group.N.get(), ctx)) {
-		BN_clear_free(n);
+	if (!power(n, secret.a.get())) {
+		shared.A.wipe();
 		return false;
 	}
 
 	if (shared.A.put(n)) {
 		return true;
 	} else {
-		BN_clear_free(n);
+		shared.A.wipe();
 		return false;
 	}
 }
@@ -348,7 +392,7 @@ bool Srp::loadHostNonce() noexcept {
 	}
 
 	//B = kv + g^b
-	auto n = BN_new();
+	auto n = shared.B.reserve();
 	if (!n) {
 		return false;
 	}
@@ -358,20 +402,20 @@ bool Srp::loadHostNonce() noexcept {
 	auto p = BN_CTX_get(ctx); //g^b
 
 	if (!m || !p) {
-		BN_clear_free(n);
+		shared.B.wipe();
 		BN_CTX_end(ctx);
 		return false;
 	}
 
 	auto ret = BN_mul(m, group.k.get(), user.v.get(), ctx) //kv
-	&& BN_mod_exp(p, group.g.get(), secret.b.get(), group.N.get(), ctx) //g^b mod N
+	&& power(p, secret.b.get()) //g^b mod N
 			&& BN_mod_add(n, m, p, group.N.get(), ctx); //(kv + g^b) mod N
 	BN_CTX_end(ctx);
 
 	if (ret && shared.B.put(n)) {
 		return true;
 	} else {
-		BN_clear_free(n);
+		shared.B.wipe();
 		return false;
 	}
 }
@@ -423,7 +467,7 @@ bool Srp::loadSessionKey(bool isHost) noexcept {
 	}
 
 	auto ret = false;
-	auto num = BN_new();
+	auto num = key.S.reserve();
 	if (!num) {
 		return false;
 	}
@@ -433,7 +477,7 @@ bool Srp::loadSessionKey(bool isHost) noexcept {
 		auto m = BN_CTX_get(ctx); //v^u
 		auto n = BN_CTX_get(ctx); //(Av^u)
 		if (!m || !n) {
-			BN_clear_free(num);
+			key.S.wipe();
 			BN_CTX_end(ctx);
 			return false;
 		}
@@ -452,7 +496,7 @@ bool Srp::loadSessionKey(bool isHost) noexcept {
 		auto p = BN_CTX_get(ctx); //kg^x
 
 		if (!m || !n || !p) {
-			BN_clear_free(num);
+			key.S.wipe();
 			BN_CTX_end(ctx);
 			return false;
 		}
@@ -469,7 +513,7 @@ bool Srp::loadSessionKey(bool isHost) noexcept {
 	}
 
 	if (!ret) {
-		BN_clear_free(num);
+		key.S.wipe();
 		return false;
 	}
 
@@ -682,6 +726,15 @@ unsigned int Srp::groupSize() const noexcept {
 	return group.N.size();
 }
 
+bool Srp::precompute(SrpGroup type) noexcept {
+	try {
+		std::call_once(precomputed[type], buildTables, type);
+		return tables[type].isReady();
+	} catch (...) {
+		return false;
+	}
+}
+
 int Srp::getStatus() const noexcept {
 	return status;
 }
@@ -941,6 +994,23 @@ bool Srp::loadMultiplierParameter() noexcept {
 			&& group.k.put(md, H.length());
 }
 
+bool Srp::power(BIGNUM *r, const BIGNUM *e) noexcept {
+	//Exponents which don't fit the tables take OpenSSL's constant time path
+	return tables[type].power(r, e, ctx)
+			|| BN_mod_exp_mont_consttime(r, group.g.get(), e, group.N.get(),
+					ctx, nullptr);
+}
+
+void Srp::buildTables(SrpGroup type) noexcept {
+	BIGNUM *N = nullptr;
+	BIGNUM *g = nullptr;
+	if (BN_hex2bn(&N, Nghex[type].Nhex) && BN_hex2bn(&g, Nghex[type].ghex)) {
+		tables[type].build(g, N, SECRETLENGTH * 8);
+	}
+	BN_free(N);
+	BN_free(g);
+}
+
 bool Srp::checkNotZero(BIGNUM *n) noexcept {
 	if (!n || !group.N.get() || !ctx) {
 		return false;
@@ -974,6 +1044,7 @@ void Srp::freeContext() noexcept {
 
 Srp::BigNumber::BigNumber() noexcept {
 	n = nullptr;
+	loaded = false;
 	bytes = 0;
 	memset(binary, 0, sizeof(binary));
 }
@@ -990,6 +1061,7 @@ bool Srp::BigNumber::put(BIGNUM *n) noexcept {
 	unsigned int size = BN_num_bytes(n);
 	if (size <= 1024 && BN_bn2bin(n, binary)) {
 		this->n = n;
+		this->loaded = true;
 		this->bytes = size;
 		return true;
 	} else {
@@ -1021,6 +1093,10 @@ bool Srp::BigNumber::put(const char *hex) noexcept {
 bool Srp::BigNumber::random(int bits, int top, int bottom) noexcept {
 	if (!n && !(n = BN_new())) {
 		return false;
+	} else if (top == BN_RAND_TOP_ANY && bottom == BN_RAND_BOTTOM_ANY
+			&& randomBits(n, bits)) {
+		//Avoids the CSPRNG's locking overhead on every call
+		return put(n);
 	} else if (!BN_rand(n, bits, top, bottom)) {
 		clear();
 		return false;
@@ -1032,7 +1108,17 @@ bool Srp::BigNumber::random(int bits, int top, int bottom) noexcept {
 bool Srp::BigNumber::pseudoRandom(const BIGNUM *range) noexcept {
 	if (!n && !(n = BN_new())) {
 		return false;
-	} else if (!BN_pseudo_rand_range(n, range)) {
+	}
+
+	//Rejection sampling, takes at most two rounds on average
+	auto bits = BN_num_bits(range);
+	for (unsigned int i = 0; i < 64 && randomBits(n, bits); ++i) {
+		if (BN_cmp(n, range) < 0) {
+			return put(n);
+		}
+	}
+
+	if (!BN_pseudo_rand_range(n, range)) {
 		clear();
 		return false;
 	} else {
@@ -1040,10 +1126,27 @@ bool Srp::BigNumber::pseudoRandom(const BIGNUM *range) noexcept {
 	}
 }
 
-BIGNUM* Srp::BigNumber::get() const noexcept {
+BIGNUM* Srp::BigNumber::reserve() noexcept {
+	loaded = false;
+	if (!n) {
+		n = BN_new();
+	}
 	return n;
 }
 
+void Srp::BigNumber::wipe() noexcept {
+	if (n) {
+		BN_clear(n);
+	}
+	loaded = false;
+	OPENSSL_cleanse(binary, sizeof(binary));
+	bytes = 0;
+}
+
+BIGNUM* Srp::BigNumber::get() const noexcept {
+	return loaded ? n : nullptr;
+}
+
 const unsigned char* Srp::BigNumber::getBinary() const noexcept {
 	return binary;
 }
@@ -1053,7 +1156,7 @@ unsigned int Srp::BigNumber::size() const noexcept {
 }
 
 void Srp::BigNumber::print() const noexcept {
-	if (n && BN_print_fp(stdout, n)) {
+	if (loaded && BN_print_fp(stdout, n)) {
 		printf("\nSIZE: %u\n", bytes);
 	} else {
 		printf("UNDEFINED\n");
@@ -1063,6 +1166,7 @@ void Srp::BigNumber::print() const noexcept {
 void Srp::BigNumber::clear() noexcept {
 	BN_clear_free(n);
 	n = nullptr;
+	loaded = false;
 	bytes = 0;
 	memset(binary, 0, sizeof(binary));
 }
@@ -12,7 +12,9 @@
 
 #ifndef WH_BASE_SECURITY_SRP_H_
 #define WH_BASE_SECURITY_SRP_H_
+#include "FixedBase.h"
 #include "Sha.h"
+#include <mutex>
 #include <openssl/bn.h>
 
 namespace wanhive {
@@ -34,6 +36,12 @@ public:
 	~Srp();
 
 	bool initialize() noexcept;
+	/*
+	 * Securely wipes the values of the current session (everything except
+	 * the group parameters) for reuse of this object. The memory allocated
+	 * for the big numbers and the BN_CTX are retained.
+	 */
+	void reset() noexcept;
 	//=================================================================
 	//Generate a random salt, if <bytes> is zero then it defaults to 16 bytes (128 bits)
 	bool loadSalt(unsigned int bytes = 0) noexcept;
@@ -157,6 +165,13 @@ public:
 	int getStatus() const noexcept;
 	void setStatus(int status) noexcept;
 	//=================================================================
+	/*
+	 * Builds the fixed-base tables of the generator of the group <type>
+	 * (once per group, shared by all the instances). Called implicitly by
+	 * <initialize>, returns true if the tables are available.
+	 */
+	static bool precompute(SrpGroup type) noexcept;
+	//=================================================================
 	/**
 	 * For testing and debugging
 	 */
@@ -175,6 +190,10 @@ private:
 	bool loadPrime() noexcept;
 	bool loadGenerator() noexcept;
 	bool loadMultiplierParameter() noexcept;
+	//Computes r = g^e mod N, uses the fixed-base tables if available
+	bool power(BIGNUM *r, const BIGNUM *e) noexcept;
+	//Builds the fixed-base tables of the group <type>
+	static void buildTables(SrpGroup type) noexcept;
 	//Checks if n % N != 0
 	bool checkNotZero(BIGNUM *n) noexcept;
 	//Checks whether n is in [0, N-1]
@@ -196,6 +215,11 @@ private:
 		bool random(int bits, int top = BN_RAND_TOP_ANY, int bottom =
 		BN_RAND_BOTTOM_ANY) noexcept;
 		bool pseudoRandom(const BIGNUM *range) noexcept;
+		//Returns the storage for computing a new value (call put to load it)
+		BIGNUM* reserve() noexcept;
+		//Zeroes and unloads the value, the storage is retained
+		void wipe() noexcept;
+		//Returns the loaded value, nullptr if none
 		BIGNUM* get() const noexcept;
 		const unsigned char* getBinary() const noexcept;
 		unsigned int size() const noexcept;
@@ -204,6 +228,7 @@ private:
 		void clear() noexcept;
 	private:
 		BIGNUM *n;
+		bool loaded;
 		unsigned int bytes;
 		//Sufficient for storing 8192 bits (largest N)
 		unsigned char binary[1024];
@@ -285,6 +310,9 @@ private:
 		const char *Nhex;
 		const char *ghex;
 	} Nghex[7];
+	//Powers of the generators, cover the secrets of default length
+	static FixedBase tables[7];
+	static std::once_flag precomputed[7];
 };
 
 } /* namespace wanhive */
@@ -0,0 +1,212 @@
+/*
+ * Admission.cpp
+ *
+ * Per source address admission control of the incoming connections
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Admission.h"
+#include "Socket.h"
+#include <cstring>
+#include <netinet/in.h>
+
+namespace {
+//Distinguishes the IPv4 keys from the IPv6 keys
+constexpr unsigned long long IPV4_TAG = 1ULL << 63;
+
+}  // namespace
+
+namespace wanhive {
+
+Admission::Admission() noexcept {
+	memset(limits, 0, sizeof(limits));
+	prefixes.ipv4 = 24;
+	prefixes.ipv6 = 48;
+}
+
+Admission::~Admission() {
+
+}
+
+void Admission::setLimits(AdmissionScope scope, unsigned int concurrent,
+		unsigned int recent) noexcept {
+	limits[scope].concurrent = concurrent;
+	limits[scope].recent = recent;
+	clear();
+}
+
+void Admission::setPrefixes(unsigned int ipv4, unsigned int ipv6) noexcept {
+	prefixes.ipv4 = Twiddler::min(ipv4, 32);
+	prefixes.ipv6 = Twiddler::min(ipv6, 64);
+	clear();
+}
+
+bool Admission::isEnabled() const noexcept {
+	for (auto &l : limits) {
+		if (l.concurrent || l.recent) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Admission::admit(const Socket *connection, unsigned long long now) noexcept {
+	Keys keys;
+	if (!isEnabled() || !getKeys(connection, keys)) {
+		return true;
+	}
+
+	if ((addresses.size() + subnets.size()) >= 2 * connections.size() + 64) {
+		expire(now);
+	}
+
+	if (!check(addresses, ADMIT_ADDRESS, keys.address, now)
+			|| !check(subnets, ADMIT_SUBNET, keys.subnet, now)) {
+		//Rejected attempts count as recent connections
+		add(addresses, keys.address, now, false);
+		return false;
+	}
+
+	if (!connections.hmPut(connection, keys)) {
+		//Fail open, the connection is not tracked
+		return true;
+	}
+
+	add(addresses, keys.address, now, true);
+	add(subnets, keys.subnet, now, true);
+	return true;
+}
+
+void Admission::remove(const Socket *connection) noexcept {
+	Keys keys;
+	auto i = connections.get(connection);
+	if (i != connections.end() && connections.getValue(i, keys)) {
+		connections.remove(i);
+		auto now = Timer::timeStamp() / 1000;
+		release(addresses, keys.address, now);
+		release(subnets, keys.subnet, now);
+	}
+}
+
+void Admission::clear() noexcept {
+	connections.clear();
+	addresses.clear();
+	subnets.clear();
+}
+
+bool Admission::getKeys(const Socket *connection, Keys &keys) const noexcept {
+	auto &sa = connection->getAddress();
+	if (sa.address.ss_family == AF_INET) {
+		auto in = (const sockaddr_in*) &sa.address;
+		unsigned long long ip = ntohl(in->sin_addr.s_addr);
+		auto mask = prefixes.ipv4 ? (0xffffffffULL << (32 - prefixes.ipv4)) : 0;
+		keys.address = IPV4_TAG | ip;
+		keys.subnet = IPV4_TAG | (ip & mask & 0xffffffffULL);
+		return true;
+	} else if (sa.address.ss_family == AF_INET6) {
+		auto in6 = (const sockaddr_in6*) &sa.address;
+		auto bytes = in6->sin6_addr.s6_addr;
+		if (IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr)) {
+			unsigned long long ip = ((unsigned long long) bytes[12] << 24)
+					| (bytes[13] << 16) | (bytes[14] << 8) | bytes[15];
+			auto mask =
+					prefixes.ipv4 ? (0xffffffffULL << (32 - prefixes.ipv4)) : 0;
+			keys.address = IPV4_TAG | ip;
+			keys.subnet = IPV4_TAG | (ip & mask & 0xffffffffULL);
+		} else {
+			unsigned long long high = 0;
+			for (unsigned int i = 0; i < 8; ++i) {
+				high = (high << 8) | bytes[i];
+			}
+			auto mask = prefixes.ipv6 ? (~0ULL << (64 - prefixes.ipv6)) : 0;
+			keys.address = Twiddler::FVN1aHash(bytes, 16) & ~IPV4_TAG;
+			keys.subnet = (high & mask) & ~IPV4_TAG;
+		}
+		return true;
+	} else {
+		return false;
+	}
+}
+
+bool Admission::check(Khash<unsigned long long, Counter> &table,
+		AdmissionScope scope, unsigned long long key,
+		unsigned long long now) noexcept {
+	auto &l = limits[scope];
+	auto i = table.get(key);
+	if (i == table.end()) {
+		return true;
+	}
+
+	auto c = table.getValueReference(i);
+	decay(*c, now);
+	return (!l.concurrent || c->active < l.concurrent)
+			&& (!l.recent || c->recent < l.recent);
+}
+
+bool Admission::add(Khash<unsigned long long, Counter> &table,
+		unsigned long long key, unsigned long long now, bool active) noexcept {
+	auto i = table.get(key);
+	if (i == table.end()) {
+		int ret = 0;
+		Counter c { 0, 0, now };
+		if ((i = table.put(key, ret)) == table.end() || !table.setValue(i, c)) {
+			return false;
+		}
+	}
+
+	auto c = table.getValueReference(i);
+	decay(*c, now);
+	c->active += active ? 1 : 0;
+	c->recent += 1;
+	return true;
+}
+
+void Admission::release(Khash<unsigned long long, Counter> &table,
+		unsigned long long key, unsigned long long now) noexcept {
+	auto i = table.get(key);
+	if (i == table.end()) {
+		return;
+	}
+
+	auto c = table.getValueReference(i);
+	decay(*c, now);
+	if (c->active) {
+		c->active -= 1;
+	}
+	if (!c->active && !c->recent) {
+		table.remove(i);
+	}
+}
+
+void Admission::decay(Counter &counter, unsigned long long now) noexcept {
+	if (now <= counter.timestamp) {
+		return;
+	}
+
+	auto periods = (now - counter.timestamp) / HALF_LIFE;
+	if (periods) {
+		counter.recent = (periods < 32) ? (counter.recent >> periods) : 0;
+		counter.timestamp += periods * HALF_LIFE;
+	}
+}
+
+void Admission::expire(unsigned long long now) noexcept {
+	Expiry expiry { &addresses, now };
+	addresses.iterate(expireCallback, &expiry);
+	expiry.table = &subnets;
+	subnets.iterate(expireCallback, &expiry);
+}
+
+int Admission::expireCallback(unsigned int index, void *arg) noexcept {
+	auto expiry = static_cast<Expiry*>(arg);
+	auto c = expiry->table->getValueReference(index);
+	decay(*c, expiry->now);
+	return (!c->active && !c->recent) ? 1 : 0;
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,129 @@
+/*
+ * Admission.h
+ *
+ * Per source address admission control of the incoming connections
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_ADMISSION_H_
+#define WH_HUB_ADMISSION_H_
+#include "../base/ds/Khash.h"
+#include "../base/ds/Twiddler.h"
+
+namespace wanhive {
+class Socket;
+
+enum AdmissionScope {
+	ADMIT_ADDRESS, //Each source address
+	ADMIT_SUBNET //Source addresses sharing the network prefix
+};
+/**
+ * Caps the number of concurrent connections and the number of recently
+ * accepted connections per source address and per subnet, so that a single
+ * host can not exhaust the connection slots. The count of the recent
+ * connections halves every second. The local (unix domain) connections are
+ * exempt.
+ * Thread safe at class level
+ */
+class Admission {
+public:
+	Admission() noexcept;
+	~Admission();
+	//-----------------------------------------------------------------
+	/*
+	 * Sets the limits of the <scope>: at most <concurrent> connections at a
+	 * time and <recent> recently accepted connections (zero disables the
+	 * limit). Resets the existing state.
+	 */
+	void setLimits(AdmissionScope scope, unsigned int concurrent,
+			unsigned int recent) noexcept;
+	//Sets the prefix lengths of the IPv4 and IPv6 subnets (capped at 32 and 64)
+	void setPrefixes(unsigned int ipv4, unsigned int ipv6) noexcept;
+	//Returns true if any one of the limits is set
+	bool isEnabled() const noexcept;
+	//-----------------------------------------------------------------
+	/*
+	 * Returns true if the newly accepted <connection> is admitted at time
+	 * <now> (in milliseconds) and accounts for it, false otherwise.
+	 */
+	bool admit(const Socket *connection, unsigned long long now) noexcept;
+	//Releases the slots held by the <connection>
+	void remove(const Socket *connection) noexcept;
+	//Releases all the state
+	void clear() noexcept;
+private:
+	struct Counter {
+		//Number of concurrent connections
+		unsigned int active;
+		//Decaying count of the recently accepted connections
+		unsigned int recent;
+		//Time of the most recent decay in milliseconds
+		unsigned long long timestamp;
+	};
+
+	//Keys of an admitted connection
+	struct Keys {
+		unsigned long long address;
+		unsigned long long subnet;
+	};
+
+	struct HFN {
+		unsigned int operator()(const Socket *s) const noexcept {
+			return Twiddler::mix((unsigned long long) s);
+		}
+	};
+
+	struct EQFN {
+		bool operator()(const Socket *s1, const Socket *s2) const noexcept {
+			return (s1 == s2);
+		}
+	};
+	//Computes the keys of the <connection>, returns false if exempt
+	bool getKeys(const Socket *connection, Keys &keys) const noexcept;
+	//Returns true if the <key> has room for another connection at <now>
+	bool check(Khash<unsigned long long, Counter> &table,
+			AdmissionScope scope, unsigned long long key,
+			unsigned long long now) noexcept;
+	//Accounts for a new connection, <active> if it has been admitted
+	static bool add(Khash<unsigned long long, Counter> &table,
+			unsigned long long key, unsigned long long now, bool active) noexcept;
+	//Releases a connection
+	static void release(Khash<unsigned long long, Counter> &table,
+			unsigned long long key, unsigned long long now) noexcept;
+	//Applies the decay to the <counter>
+	static void decay(Counter &counter, unsigned long long now) noexcept;
+	//Releases the counters idle at time <now>
+	void expire(unsigned long long now) noexcept;
+	static int expireCallback(unsigned int index, void *arg) noexcept;
+public:
+	//Half-life of the count of the recent connections in milliseconds
+	static constexpr unsigned int HALF_LIFE = 1000;
+private:
+	struct Expiry {
+		Khash<unsigned long long, Counter> *table;
+		unsigned long long now;
+	};
+
+	struct {
+		unsigned int concurrent;
+		unsigned int recent;
+	} limits[2];
+
+	struct {
+		unsigned int ipv4;
+		unsigned int ipv6;
+	} prefixes;
+
+	Khash<const Socket*, Keys, true, HFN, EQFN> connections;
+	Khash<unsigned long long, Counter> addresses;
+	Khash<unsigned long long, Counter> subnets;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_ADMISSION_H_ */
@@ -25,6 +25,7 @@ enum {
 	WHC_ROOT,
 	WHC_GETKEY,
 	WHC_AUTHORIZE,
+	WHC_RESUME,
 	WHC_ERROR,
 	WHC_REGISTERED,
 	WHC_FATAL
@@ -48,6 +49,12 @@ bool ClientHub::isConnected() const noexcept {
 }
 
 void ClientHub::stop(Watcher *w) noexcept {
+	for (auto &s : probes.sockets) {
+		if (w == s) {
+			s = nullptr;
+		}
+	}
+
 	if (w == bs.auth) {
 		bs.auth = nullptr;
 	} else if (w == bs.node) {
@@ -72,11 +79,20 @@ void ClientHub::configure(void *arg) {
 		ctx.passwordHashRounds = conf.getNumber("CLIENT", "passwordHashRounds");
 		ctx.timeOut = conf.getNumber("CLIENT", "timeOut", 5000);
 		ctx.retryInterval = conf.getNumber("CLIENT", "retryInterval", 10000);
+		ctx.resumeInterval = conf.getNumber("CLIENT", "resumeInterval");
+		ctx.parallelConnections = conf.getNumber("CLIENT",
+				"parallelConnections", 3);
+		ctx.parallelConnections = Twiddler::min(ctx.parallelConnections,
+				PROBES);
+		ctx.parallelConnections =
+				ctx.parallelConnections ? ctx.parallelConnections : 1;
+		ctx.connectionDelay = conf.getNumber("CLIENT", "connectionDelay", 250);
 
 		WH_LOG_DEBUG(
-				"Client hub settings:\nPASSWORD=\"%s\", HASHROUNDS=%u, TIMEOUT=%ums, RETRYINTERVAL=%ums\n",
+				"Client hub settings:\nPASSWORD=\"%s\", HASHROUNDS=%u, TIMEOUT=%ums, RETRYINTERVAL=%ums, RESUMEINTERVAL=%ums,\nPARALLEL_CONNECTIONS=%u, CONNECTION_DELAY=%ums\n",
 				ctx.password, ctx.passwordHashRounds, ctx.timeOut,
-				ctx.retryInterval);
+				ctx.retryInterval, ctx.resumeInterval,
+				ctx.parallelConnections, ctx.connectionDelay);
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
 		throw;
@@ -98,6 +114,10 @@ void ClientHub::route(Message *message) noexcept {
 
 	switch (command) {
 	case WH_CMD_NULL:
+		if (isStage(WHC_IDENTIFY) && !bs.auth) {
+			adopt(origin);
+		}
+
 		if (isStage(WHC_ERROR) || isStage(WHC_REGISTERED) || isStage(WHC_FATAL)
 				|| !bs.auth) {
 			//Bad message
@@ -114,7 +134,13 @@ void ClientHub::route(Message *message) noexcept {
 		}
 		break;
 	case WH_CMD_BASIC:
-		if (isStage(WHC_ERROR) || isStage(WHC_REGISTERED) || isStage(WHC_FATAL)
+		if (isStage(WHC_BOOTSTRAP) && !bs.node) {
+			adopt(origin);
+		}
+
+		if (qualifier == WH_QLF_RESUME || isStage(WHC_RESUME)) {
+			processResumeResponse(message);
+		} else if (isStage(WHC_ERROR) || isStage(WHC_REGISTERED) || isStage(WHC_FATAL)
 				|| !bs.node || (ctx.password && !bs.auth)) {
 			//Bad message
 		} else if (!(origin == bs.node->getUid()
@@ -158,13 +184,30 @@ void ClientHub::maintain() noexcept {
 			setStage(WHC_ERROR);
 		}
 		break;
+	case WHC_RESUME:
+		if (!bs.node || checkStageTimeout(ctx.timeOut)) {
+			setStage(WHC_ERROR);
+		}
+		break;
 	case WHC_ERROR:
-		if (checkStageTimeout(ctx.retryInterval)) {
+		if (!checkStageTimeout(ctx.retryInterval)) {
+			break;
+		} else if (resumption.length) {
+			resume();
+		} else {
 			setStage(WHC_IDENTIFY);
 		}
 		break;
 	case WHC_REGISTERED:
-		if (!bs.node) {
+		if (bs.node) {
+			if (ctx.resumeInterval
+					&& resumption.timer.hasTimedOut(ctx.resumeInterval)) {
+				requestToken();
+			}
+		} else if (resumption.length) {
+			//Reconnect immediately
+			resume();
+		} else {
 			setStage(WHC_ERROR);
 		}
 		break;
@@ -189,7 +232,6 @@ unsigned short ClientHub::nextSequenceNumber() noexcept {
 }
 
 void ClientHub::connectToAuthenticator() noexcept {
-	Socket *s = nullptr;
 	try {
 		//-----------------------------------------------------------------
 		//Check for consistency
@@ -203,44 +245,14 @@ void ClientHub::connectToAuthenticator() noexcept {
 			return;
 		}
 		//-----------------------------------------------------------------
-		//Check for timeout on the existing authentication node
-		if (bs.auth) {
-			if (bs.auth->hasTimedOut(ctx.timeOut)) {
-				WH_LOG_DEBUG("Connection timed out");
-				disable(bs.auth);
-			}
-			return;
-		}
-		//-----------------------------------------------------------------
-		//Load the list of identifiers if necessary
-		if (!bs.identifiers.hasSpace()) {
-			loadIdentifiers(true);
-		}
-		//-----------------------------------------------------------------
-		//Get the next identifier to probe
-		unsigned long long id;
-		if (!bs.identifiers.get(id) || !id) {
-			setStage(WHC_ERROR);
-			throw Exception(EX_RESOURCE);
-		}
-		//-----------------------------------------------------------------
-		//Establish new connection
-		NameInfo ni;
-		Identity::getAddress(id, ni);
-		s = new Socket(ni);
-		s->setUid(id);
-		s->publish(createIdentificationRequest());
-		putWatcher(s, IO_WR, WATCHER_ACTIVE);
-		bs.auth = s;
-		WH_LOG_DEBUG("Contacting authentication node %llu", bs.auth->getUid());
+		//Contact the authentication nodes
+		probe(true);
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
-		delete s;
 	}
 }
 
 void ClientHub::connectToOverlay() noexcept {
-	Socket *s = nullptr;
 	try {
 		//-----------------------------------------------------------------
 		//Check for consistency
@@ -248,44 +260,117 @@ void ClientHub::connectToOverlay() noexcept {
 			throw Exception(EX_INVALIDSTATE);
 		}
 		//-----------------------------------------------------------------
-		//Check for timeout on the existing authentication node
-		if (bs.node) {
-			if (bs.node->hasTimedOut(ctx.timeOut)) {
+		//Contact the bootstrap nodes
+		probe(false);
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+bool ClientHub::checkStageTimeout(unsigned int milliseconds) const noexcept {
+	return bs.timer.hasTimedOut(milliseconds);
+}
+
+void ClientHub::probe(bool auth) noexcept {
+	Socket *s = nullptr;
+	try {
+		//-----------------------------------------------------------------
+		//Drop the attempts which have timed out, count the rest
+		unsigned int active = 0;
+		Socket **slot = nullptr;
+		for (auto &p : probes.sockets) {
+			if (p && p->hasTimedOut(ctx.timeOut)) {
 				WH_LOG_DEBUG("Connection timed out");
-				disable(bs.node);
+				disable(p);
+				p = nullptr;
+			}
+
+			if (p) {
+				++active;
+			} else if (!slot) {
+				slot = &p;
 			}
+		}
+		//-----------------------------------------------------------------
+		//Stagger the attempts, the first one goes out immediately
+		if (active && (active >= ctx.parallelConnections
+				|| !probes.timer.hasTimedOut(ctx.connectionDelay))) {
 			return;
 		}
 		//-----------------------------------------------------------------
 		//Load the list of identifiers if necessary
-		if (!bs.identifiers.hasSpace()) {
-			loadIdentifiers(false);
+		if (!bs.identifiers.hasSpace() && !bs.identifiers.getStatus()) {
+			loadIdentifiers(auth);
 		}
 		//-----------------------------------------------------------------
 		//Get the next identifier to probe
 		unsigned long long id;
-		if (!bs.identifiers.get(id) || !id) {
+		if (bs.identifiers.get(id) && id) {
+			//Establish new connection
+		} else if (active) {
+			//Wait for the attempts in progress
+			return;
+		} else {
 			setStage(WHC_ERROR);
 			throw Exception(EX_RESOURCE);
 		}
 		//-----------------------------------------------------------------
 		//Establish new connection
+		probes.timer.now();
 		NameInfo ni;
 		Identity::getAddress(id, ni);
 		s = new Socket(ni);
 		s->setUid(id);
-		s->publish(createFindRootRequest());
+		s->publish(createProbeRequest(auth));
 		putWatcher(s, IO_WR, WATCHER_ACTIVE);
-		bs.node = s;
-		WH_LOG_DEBUG("Contacting bootstrap node %llu", bs.node->getUid());
+		*slot = s;
+		WH_LOG_DEBUG("Contacting %s node %llu",
+				(auth ? "authentication" : "bootstrap"), id);
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
 		delete s;
 	}
 }
 
-bool ClientHub::checkStageTimeout(unsigned int milliseconds) const noexcept {
-	return bs.timer.hasTimedOut(milliseconds);
+Message* ClientHub::createProbeRequest(bool auth) {
+	if (probes.length) {
+		//Same request (and the nonce) for all the nodes
+		auto msg = Message::create();
+		if (msg && msg->pack(probes.request)) {
+			return msg;
+		} else {
+			Message::recycle(msg);
+			throw Exception(EX_ALLOCFAILED);
+		}
+	} else {
+		auto msg = auth ? createIdentificationRequest() : createFindRootRequest();
+		probes.length = msg->getLength();
+		memcpy(probes.request, msg->getStorage(), probes.length);
+		return msg;
+	}
+}
+
+void ClientHub::adopt(unsigned long long id) noexcept {
+	for (auto &p : probes.sockets) {
+		if (p && p->getUid() == id) {
+			if (isStage(WHC_IDENTIFY)) {
+				bs.auth = p;
+			} else {
+				bs.node = p;
+			}
+			p = nullptr;
+			cancelProbes();
+			return;
+		}
+	}
+}
+
+void ClientHub::cancelProbes() noexcept {
+	for (auto &p : probes.sockets) {
+		disable(p);
+		p = nullptr;
+	}
+	probes.length = 0;
 }
 
 void ClientHub::initAuthentication() noexcept {
@@ -373,6 +458,68 @@ void ClientHub::initAuthorization() noexcept {
 	}
 }
 
+void ClientHub::resume() noexcept {
+	Socket *s = nullptr;
+	try {
+		if (!resumption.length || !resumption.node || bs.node) {
+			throw Exception(EX_INVALIDSTATE);
+		} else if (resumption.attempts >= RESUME_ATTEMPTS) {
+			WH_LOG_DEBUG("Giving up on the session resumption");
+			clearToken();
+			setStage(WHC_IDENTIFY);
+			return;
+		}
+		//-----------------------------------------------------------------
+		//The token replaces the authentication and bootstrapping
+		NameInfo ni;
+		Identity::getAddress(resumption.node, ni);
+		s = new Socket(ni);
+		s->setUid(resumption.node);
+		//The proof of ownership requires a nonce bound to this connection
+		uint64_t rnd[2];
+		Random prng;
+		prng.bytes(rnd, sizeof(rnd));
+		generateNonce(bs.hashFn, rnd[0], rnd[1], &bs.nonce);
+		auto msg = Protocol::createGetKeyRequest(0,
+				{ verifyHost() ? getPKI() : nullptr, &bs.nonce }, nullptr);
+		if (!msg) {
+			throw Exception(EX_ALLOCFAILED);
+		}
+		s->publish(msg);
+		putWatcher(s, IO_WR, WATCHER_ACTIVE);
+		bs.node = s;
+		resumption.attempts += 1;
+		setStage(WHC_RESUME);
+		WH_LOG_DEBUG("Resuming the session with node %llu", resumption.node);
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+		delete s;
+		clearToken();
+		setStage(WHC_ERROR);
+	}
+}
+
+void ClientHub::requestToken() noexcept {
+	resumption.timer.now();
+	//The secret is encrypted with the overlay's public key
+	PKIEncryptedData proof;
+	if (!bs.node || !getPKI()
+			|| !getPKI()->encrypt(resumption.secret, Hash::SIZE, &proof)) {
+		return;
+	}
+
+	auto msg = Protocol::createResumeRequest(0, getUid(), 0, nullptr, 0,
+			&proof);
+	if (!msg) {
+		return;
+	}
+
+	msg->setDestination(bs.node->getUid());
+	if (!Hub::sendMessage(msg)) {
+		Message::recycle(msg);
+	}
+}
+
 Message* ClientHub::createIdentificationRequest() {
 	try {
 		const unsigned char *binary = nullptr;
@@ -528,9 +675,17 @@ void ClientHub::processRegistrationResponse(Message *msg) noexcept {
 			|| status == WH_AQLF_REJECTED) {
 		setStage(WHC_ERROR);
 	} else if (origin == bs.node->getUid() && status == WH_AQLF_ACCEPTED) {
-		if (Hub::registerWatcher(bs.node->getUid(), 0, true)) {
+		if (Hub::registerWatcher(origin, 0, true)) {
 			WH_LOG_INFO("Registration succeeded");
 			setStage(WHC_REGISTERED);
+			//Resume the session with the same node
+			clearToken();
+			resumption.node = origin;
+			Random prng;
+			prng.bytes(resumption.secret, sizeof(resumption.secret));
+			if (ctx.resumeInterval) {
+				requestToken();
+			}
 		} else {
 			setStage(WHC_ERROR);
 		}
@@ -542,11 +697,99 @@ void ClientHub::processRegistrationResponse(Message *msg) noexcept {
 	}
 }
 
+void ClientHub::processResumeResponse(Message *msg) noexcept {
+	auto origin = msg->getOrigin();
+	auto source = msg->getSource();
+	auto status = msg->getStatus();
+	if (!bs.node || origin != bs.node->getUid()) {
+		//Bad message
+	} else if (!(source == 0 || source == getUid())) {
+		//Bad message
+	} else if (isStage(WHC_REGISTERED)) {
+		//Response to the token request
+		if (status == WH_AQLF_ACCEPTED) {
+			storeToken(msg);
+		}
+	} else if (!isStage(WHC_RESUME)) {
+		//Bad message
+	} else if (msg->getQualifier() == WH_QLF_GETKEY) {
+		proveToken(msg);
+	} else if (msg->getQualifier() != WH_QLF_RESUME) {
+		//Bad message
+	} else if (status != WH_AQLF_ACCEPTED) {
+		//Expired or invalid token, start over
+		WH_LOG_DEBUG("Session resumption denied");
+		clearToken();
+		disable(bs.node);
+		setStage(WHC_IDENTIFY);
+	} else if (Hub::registerWatcher(origin, 0, true)) {
+		//The token has been consumed, the response may carry a new one
+		resumption.length = 0;
+		storeToken(msg);
+		WH_LOG_INFO("Session resumed");
+		setStage(WHC_REGISTERED);
+	} else {
+		setStage(WHC_ERROR);
+	}
+}
+
+void ClientHub::proveToken(Message *msg) noexcept {
+	if (!Protocol::verify(msg, (verifyHost() ? getPKI() : nullptr))
+			|| !Protocol::processGetKeyResponse(msg, &bs.nonce)) {
+		setStage(WHC_ERROR);
+		return;
+	}
+
+	//Only the overlay can read the secret, the nonce binds it to this connection
+	unsigned char block[2 * Hash::SIZE]; //[SECRET][NONCE]
+	memcpy(block, resumption.secret, Hash::SIZE);
+	memcpy(block + Hash::SIZE, bs.nonce, Hash::SIZE);
+	PKIEncryptedData proof;
+	Message *request = nullptr;
+	if (getPKI() && getPKI()->encrypt(block, sizeof(block), &proof)) {
+		request = Protocol::createResumeRequest(0, getUid(), 0,
+				resumption.token, resumption.length, &proof);
+	}
+	memset(block, 0, sizeof(block));
+
+	if (!request) {
+		setStage(WHC_ERROR);
+		return;
+	}
+
+	request->setDestination(bs.node->getUid());
+	if (!Hub::sendMessage(request)) {
+		Message::recycle(request);
+		setStage(WHC_ERROR);
+	}
+}
+
+void ClientHub::storeToken(const Message *msg) noexcept {
+	unsigned int length = 0;
+	const unsigned char *token = nullptr;
+	if (Protocol::processResumeResponse(msg, length, token) && length
+			&& length <= sizeof(resumption.token)) {
+		memcpy(resumption.token, token, length);
+		resumption.length = length;
+		resumption.attempts = 0;
+		resumption.timer.now();
+	}
+}
+
+void ClientHub::clearToken() noexcept {
+	memset(resumption.token, 0, sizeof(resumption.token));
+	resumption.length = 0;
+	memset(resumption.secret, 0, sizeof(resumption.secret));
+	resumption.node = 0;
+	resumption.attempts = 0;
+}
+
 void ClientHub::setStage(int stage) noexcept {
 	if (stage != bs.stage) {
 		connected = (stage == WHC_REGISTERED);
 		bs.stage = stage;
 		bs.timer.now();
+		cancelProbes();
 
 		if (stage == WHC_IDENTIFY || stage == WHC_BOOTSTRAP) {
 			clearIdentifiers();
@@ -617,6 +860,15 @@ void ClientHub::clear() noexcept {
 	memset(&bs.nonce, 0, sizeof(bs.nonce));
 	bs.stage = WHC_IDENTIFY;
 	bs.sn = 1;
+
+	for (auto &p : probes.sockets) {
+		p = nullptr;
+	}
+	probes.length = 0;
+	probes.timer.now();
+
+	clearToken();
+	resumption.timer.now();
 }
 
 } /* namespace wanhive */
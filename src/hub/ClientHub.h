@@ -47,12 +47,24 @@ private:
 	void connectToOverlay() noexcept;
 	//Checks whether the current stage is taking longer than expected to finish
 	bool checkStageTimeout(unsigned int milliseconds) const noexcept;
+	//Staggered parallel connection attempts to the authentication/bootstrap nodes
+	void probe(bool auth) noexcept;
+	//Returns the request sent to the node being probed
+	Message* createProbeRequest(bool auth);
+	//Keeps the probe which answered first, cancels the rest
+	void adopt(unsigned long long id) noexcept;
+	//Cancels all the connection attempts in progress
+	void cancelProbes() noexcept;
 	//Called by processIdentificationResponse
 	void initAuthentication() noexcept;
 	//Called by processFindRootResponse
 	void findRoot() noexcept;
 	//Called by processGetKeyResponse
 	void initAuthorization() noexcept;
+	//Reconnects with the overlay using the resumption token
+	void resume() noexcept;
+	//Requests a new resumption token from the overlay
+	void requestToken() noexcept;
 
 	Message* createIdentificationRequest();
 	void processIdentificationResponse(Message *msg) noexcept;
@@ -68,6 +80,12 @@ private:
 	Message* createRegistrationMessage(bool sign);
 	void processRegistrationResponse(Message *msg) noexcept;
 
+	void processResumeResponse(Message *msg) noexcept;
+	//Proves the ownership of the token over the nonce sent by the overlay
+	void proveToken(Message *msg) noexcept;
+	void storeToken(const Message *msg) noexcept;
+	void clearToken() noexcept;
+
 	void setStage(int stage) noexcept;
 	int getStage() const noexcept;
 	bool isStage(int stage) const noexcept;
@@ -90,6 +108,12 @@ private:
 		unsigned int timeOut;
 		//Wait for these many milliseconds before reconnecting
 		unsigned int retryInterval;
+		//Maximum number of parallel connection attempts during bootstrap
+		unsigned int parallelConnections;
+		//Delay between the parallel connection attempts in milliseconds
+		unsigned int connectionDelay;
+		//Refresh the resumption token periodically (0 disables the resumption)
+		unsigned int resumeInterval;
 	} ctx;
 
 	/**
@@ -111,6 +135,37 @@ private:
 		int stage;
 		unsigned short sn;
 	} bs;
+
+	/**
+	 * Connection attempts in progress (first one to answer is kept)
+	 */
+	static constexpr unsigned int PROBES = 4;
+	struct {
+		Socket *sockets[PROBES];
+		//Serialized request sent out to every node being probed
+		unsigned char request[Message::MTU];
+		unsigned int length;
+		//Measures the delay between the attempts
+		Timer timer;
+	} probes;
+
+	/**
+	 * For fast reconnection (session resumption)
+	 */
+	static constexpr unsigned int RESUME_ATTEMPTS = 3;
+	struct {
+		//The opaque token issued by the overlay
+		unsigned char token[Message::PAYLOAD_SIZE];
+		unsigned int length;
+		//The token is bound to this secret (never sent out in clear)
+		Digest secret;
+		//The overlay node which issued the token
+		unsigned long long node;
+		//Failed reconnection attempts with the current token
+		unsigned int attempts;
+		//Measures the token refresh interval
+		Timer timer;
+	} resumption;
 };
 
 } /* namespace wanhive */
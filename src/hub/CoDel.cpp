@@ -0,0 +1,117 @@
+/*
+ * CoDel.cpp
+ *
+ * Controlled delay active queue management
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "CoDel.h"
+#include <cmath>
+
+namespace wanhive {
+
+decltype(CoDel::options) CoDel::options = { 0, 100000 };
+
+CoDel::CoDel() noexcept {
+	clear();
+}
+
+CoDel::~CoDel() {
+
+}
+
+void CoDel::clear() noexcept {
+	firstAboveTime = 0;
+	dropNext = 0;
+	drops = 0;
+	lastDrops = 0;
+	dropping = false;
+	stats.messages = 0;
+	stats.bytes = 0;
+}
+
+bool CoDel::drop(unsigned long long sojourn, unsigned long long now,
+		bool backlogged) noexcept {
+	if (!options.target) {
+		return false;
+	}
+
+	auto okToDrop = isAboveTarget(sojourn, now, backlogged);
+	if (dropping) {
+		if (!okToDrop) {
+			//Sojourn time went below the target, leave the dropping state
+			dropping = false;
+			return false;
+		} else if (now >= dropNext) {
+			//Increase the drop rate
+			++drops;
+			dropNext = controlLaw(dropNext);
+			return true;
+		} else {
+			return false;
+		}
+	} else if (okToDrop) {
+		dropping = true;
+		//Resume at the recent drop rate if the dropping state was left lately
+		auto delta = drops - lastDrops;
+		if (delta > 1 && (now - dropNext) < (16ULL * options.interval)) {
+			drops = delta;
+		} else {
+			drops = 1;
+		}
+		lastDrops = drops;
+		dropNext = controlLaw(now);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+void CoDel::count(unsigned int bytes) noexcept {
+	stats.messages += 1;
+	stats.bytes += bytes;
+}
+
+unsigned long long CoDel::messagesDropped() const noexcept {
+	return stats.messages;
+}
+
+unsigned long long CoDel::bytesDropped() const noexcept {
+	return stats.bytes;
+}
+
+void CoDel::setOptions(unsigned int target, unsigned int interval) noexcept {
+	//Stored in microseconds, the resolution of the timestamps
+	options.target = target * 1000ULL;
+	options.interval = (interval ? interval : 1) * 1000ULL;
+}
+
+bool CoDel::isEnabled() noexcept {
+	return options.target != 0;
+}
+
+bool CoDel::isAboveTarget(unsigned long long sojourn, unsigned long long now,
+		bool backlogged) noexcept {
+	if (sojourn < options.target || !backlogged) {
+		//No standing queue
+		firstAboveTime = 0;
+		return false;
+	} else if (!firstAboveTime) {
+		//Give the queue an interval to drain
+		firstAboveTime = now + options.interval;
+		return false;
+	} else {
+		return now >= firstAboveTime;
+	}
+}
+
+unsigned long long CoDel::controlLaw(unsigned long long t) const noexcept {
+	return t + (unsigned long long) (options.interval / std::sqrt(drops));
+}
+
+} /* namespace wanhive */
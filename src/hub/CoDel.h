@@ -0,0 +1,79 @@
+/*
+ * CoDel.h
+ *
+ * Controlled delay active queue management
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_CODEL_H_
+#define WH_HUB_CODEL_H_
+
+namespace wanhive {
+/**
+ * Controlled delay (CoDel, RFC 8289) queue management: the messages are
+ * time-stamped on enqueue and their sojourn time is examined on dequeue. Once
+ * the minimum sojourn time has stayed above the <target> for an <interval>,
+ * messages are dropped at an increasing rate until the standing queue
+ * disappears. The settings are shared by all the instances.
+ * Thread safe at class level
+ */
+class CoDel {
+public:
+	CoDel() noexcept;
+	~CoDel();
+	//Resets the control state and the statistics
+	void clear() noexcept;
+	/*
+	 * Returns true if the message at the head of the queue, which has spent
+	 * <sojourn> microseconds in the queue, should be dropped at time <now> (in
+	 * microseconds, see Timer::timeStamp).
+	 * Set <backlogged> to false if no other message is waiting behind it.
+	 */
+	bool drop(unsigned long long sojourn, unsigned long long now,
+			bool backlogged) noexcept;
+	//Records a dropped message of <bytes> length
+	void count(unsigned int bytes) noexcept;
+	//Returns the number of messages dropped so far
+	unsigned long long messagesDropped() const noexcept;
+	//Returns the number of bytes dropped so far
+	unsigned long long bytesDropped() const noexcept;
+	//-----------------------------------------------------------------
+	/*
+	 * Sets the <target> sojourn time and the <interval> in milliseconds, zero
+	 * (0) <target> disables the queue management.
+	 */
+	static void setOptions(unsigned int target, unsigned int interval) noexcept;
+	//Returns true if the queue management is in use
+	static bool isEnabled() noexcept;
+private:
+	//Returns true if the sojourn time has been above the target long enough
+	bool isAboveTarget(unsigned long long sojourn, unsigned long long now,
+			bool backlogged) noexcept;
+	//Returns the time of the next drop relative to <t>
+	unsigned long long controlLaw(unsigned long long t) const noexcept;
+private:
+	unsigned long long firstAboveTime; //Sojourn time went above the target
+	unsigned long long dropNext; //Time of the next drop
+	unsigned int drops; //Drops since entering the dropping state
+	unsigned int lastDrops; //Drops during the last dropping state
+	bool dropping; //The dropping state
+	struct {
+		unsigned long long messages;
+		unsigned long long bytes;
+	} stats;
+
+	//In microseconds
+	static struct {
+		unsigned long long target;
+		unsigned long long interval;
+	} options;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_CODEL_H_ */
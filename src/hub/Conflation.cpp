@@ -0,0 +1,72 @@
+/*
+ * Conflation.cpp
+ *
+ * Conflation settings of the topic subscriptions
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Conflation.h"
+#include "../base/ds/Serializer.h"
+
+namespace wanhive {
+
+void Conflation::clear() noexcept {
+	enabled = 0;
+	width = 0;
+	offset = 0;
+}
+
+bool Conflation::set(unsigned int offset, unsigned int width) noexcept {
+	if (width > sizeof(uint64_t) || offset > 0xffff) {
+		return false;
+	} else {
+		this->enabled = 1;
+		this->width = width;
+		this->offset = offset;
+		return true;
+	}
+}
+
+bool Conflation::isEnabled() const noexcept {
+	return enabled;
+}
+
+bool Conflation::getKey(const unsigned char *payload, unsigned int length,
+		uint64_t &key) const noexcept {
+	key = 0;
+	if (!width) {
+		return true;
+	} else if (!payload || ((unsigned int) offset + width) > length) {
+		return false;
+	}
+
+	for (unsigned int i = 0; i < width; ++i) {
+		key = (key << 8) | payload[offset + i];
+	}
+	return true;
+}
+
+unsigned int Conflation::pack(unsigned char *buffer) const noexcept {
+	buffer[0] = enabled;
+	buffer[1] = width;
+	Serializer::packi16(buffer + 2, offset);
+	return SIZE;
+}
+
+bool Conflation::unpack(const unsigned char *buffer) noexcept {
+	clear();
+	if (buffer[0] > 1 || buffer[1] > sizeof(uint64_t)) {
+		return false;
+	} else if (buffer[0]) {
+		return set(Serializer::unpacku16(buffer + 2), buffer[1]);
+	} else {
+		return true;
+	}
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,56 @@
+/*
+ * Conflation.h
+ *
+ * Conflation settings of the topic subscriptions
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_CONFLATION_H_
+#define WH_HUB_CONFLATION_H_
+#include <cstdint>
+
+namespace wanhive {
+/**
+ * Opt-in conflation of a subscription: while the subscriber's outgoing queue
+ * is backed up, a queued publication is replaced by a newer one having the
+ * same key. The key is the topic plus an optional payload field (an unsigned
+ * big-endian integer at a fixed offset).
+ * POD type, call clear() before use.
+ * Thread safe at class level
+ */
+class Conflation {
+public:
+	//Disables the conflation
+	void clear() noexcept;
+	//Conflates by topic and the <width> (0-8) byte payload field at <offset>
+	bool set(unsigned int offset, unsigned int width) noexcept;
+	//Returns true if the conflation is enabled
+	bool isEnabled() const noexcept;
+	/*
+	 * Extracts the conflation key from the <payload> of the given <length>,
+	 * returns false if the payload is too short (never conflated).
+	 */
+	bool getKey(const unsigned char *payload, unsigned int length,
+			uint64_t &key) const noexcept;
+
+	//Serializes the settings into <buffer> (SIZE bytes), returns SIZE
+	unsigned int pack(unsigned char *buffer) const noexcept;
+	//Deserializes the settings from <buffer> (SIZE bytes), false if invalid
+	bool unpack(const unsigned char *buffer) noexcept;
+public:
+	//Serialized size (flags, width and offset)
+	static constexpr unsigned int SIZE = 4;
+private:
+	uint8_t enabled;
+	uint8_t width;
+	uint16_t offset;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_CONFLATION_H_ */
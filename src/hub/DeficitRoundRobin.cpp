@@ -0,0 +1,72 @@
+/*
+ * DeficitRoundRobin.cpp
+ *
+ * Deficit round-robin scheduling of the incoming messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "DeficitRoundRobin.h"
+#include "Socket.h"
+
+namespace wanhive {
+
+DeficitRoundRobin::DeficitRoundRobin() noexcept :
+		quantumSize(Message::MTU), weights { 1, 1, 1 } {
+
+}
+
+DeficitRoundRobin::~DeficitRoundRobin() {
+
+}
+
+void DeficitRoundRobin::setQuantum(unsigned int quantum) noexcept {
+	//A turn must admit at least one message
+	quantumSize = quantum ? quantum : Message::MTU;
+}
+
+unsigned int DeficitRoundRobin::getQuantum() const noexcept {
+	return quantumSize;
+}
+
+void DeficitRoundRobin::setWeights(unsigned int client, unsigned int overlay,
+		unsigned int priority) noexcept {
+	weights.client = client ? client : 1;
+	weights.overlay = overlay ? overlay : 1;
+	weights.priority = priority ? priority : 1;
+}
+
+bool DeficitRoundRobin::start(Socket *connection) noexcept {
+	auto credit = connection->getCredit() + quantum(connection);
+	connection->setCredit(credit);
+	return credit > 0;
+}
+
+bool DeficitRoundRobin::charge(Socket *connection,
+		const Message *message) noexcept {
+	auto credit = connection->getCredit() - message->getLength();
+	connection->setCredit(credit);
+	return credit > 0;
+}
+
+void DeficitRoundRobin::stop(Socket *connection, bool idle) noexcept {
+	if (idle && connection->getCredit() > 0) {
+		connection->setCredit(0);
+	}
+}
+
+long long DeficitRoundRobin::quantum(const Socket *connection) const noexcept {
+	if (connection->testFlags(SOCKET_PRIORITY)) {
+		return (long long) quantumSize * weights.priority;
+	} else if (connection->testFlags(SOCKET_OVERLAY)) {
+		return (long long) quantumSize * weights.overlay;
+	} else {
+		return (long long) quantumSize * weights.client;
+	}
+}
+
+} /* namespace wanhive */
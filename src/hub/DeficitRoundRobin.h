@@ -0,0 +1,56 @@
+/*
+ * DeficitRoundRobin.h
+ *
+ * Deficit round-robin scheduling of the incoming messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_DEFICITROUNDROBIN_H_
+#define WH_HUB_DEFICITROUNDROBIN_H_
+#include "Scheduler.h"
+
+namespace wanhive {
+/**
+ * Deficit round-robin over the connections: each turn a connection earns a
+ * quantum of bytes proportional to the weight of its class (client, overlay
+ * or priority) and spends it on the received messages. The last message of
+ * a turn may overdraw the credit, the debt is paid back during the next turn.
+ * A connection which runs out of messages forfeits its unused credit.
+ * Thread safe at class level
+ */
+class DeficitRoundRobin: public Scheduler {
+public:
+	DeficitRoundRobin() noexcept;
+	~DeficitRoundRobin();
+	//-----------------------------------------------------------------
+	//Bytes earned per turn by a connection of unit weight
+	void setQuantum(unsigned int quantum) noexcept;
+	unsigned int getQuantum() const noexcept;
+	//Weights of the client, overlay and priority connections (at least 1)
+	void setWeights(unsigned int client, unsigned int overlay,
+			unsigned int priority) noexcept;
+	//-----------------------------------------------------------------
+	bool start(Socket *connection) noexcept override final;
+	bool charge(Socket *connection, const Message *message) noexcept
+			override final;
+	void stop(Socket *connection, bool idle) noexcept override final;
+private:
+	//Returns the quantum of the <connection> for this turn
+	long long quantum(const Socket *connection) const noexcept;
+private:
+	unsigned int quantumSize;
+	struct {
+		unsigned int client;
+		unsigned int overlay;
+		unsigned int priority;
+	} weights;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_DEFICITROUNDROBIN_H_ */
@@ -214,10 +214,19 @@ bool Hub::retainMessage(Message *message) noexcept {
 	}
 }
 
+void Hub::setScheduler(Scheduler *scheduler) noexcept {
+	this->scheduler = scheduler;
+}
+
 bool Hub::sendMessage(Message *message) noexcept {
 	if (message && !message->isMarked() && outgoingMessages.put(message)) {
-		message->putFlags(MSG_PROCESSED);
+		//The priority is preserved
+		message->putFlags(
+				MSG_PROCESSED | (message->getFlags() & MSG_PRIORITY));
 		message->setMarked();
+		if (CoDel::isEnabled()) {
+			message->setTimestamp(Timer::timeStamp());
+		}
 		return true;
 	} else {
 		return false;
@@ -246,7 +255,7 @@ void Hub::stop(Watcher *w) noexcept {
 	 */
 	auto error = (w == notifiers.listener) || (w == notifiers.clock)
 			|| (w == notifiers.enotifier) || (w == notifiers.inotifier)
-			|| (w == notifiers.signalWatcher);
+			|| (w == notifiers.signalWatcher) || (w == notifiers.alarm);
 
 	if (error) {
 		WH_LOG_ERROR("Fatal component failure, exiting.");
@@ -254,6 +263,9 @@ void Hub::stop(Watcher *w) noexcept {
 	} else {
 		auto id = w->getUid();
 		watchers.remove(id);
+		limiter.remove(static_cast<Socket*>(w));
+		admission.remove(static_cast<Socket*>(w));
+		starved.removeKey(static_cast<Socket*>(w));
 		w->stop();
 		delete w;
 		WH_LOG_DEBUG("Watcher %llu recycled", id);
@@ -296,11 +308,41 @@ void Hub::configure(void *arg) {
 		}
 		ctx.connectionTimeOut = conf.getNumber("HUB", "connectionTimeOut",
 				2000);
+		ctx.addressConnections = conf.getNumber("HUB", "addressConnections");
+		ctx.addressNewConnections = conf.getNumber("HUB",
+				"addressNewConnections");
+		ctx.subnetConnections = conf.getNumber("HUB", "subnetConnections");
+		ctx.subnetNewConnections = conf.getNumber("HUB",
+				"subnetNewConnections");
+		ctx.subnetPrefixIPv4 = conf.getNumber("HUB", "subnetPrefixIPv4", 24);
+		ctx.subnetPrefixIPv6 = conf.getNumber("HUB", "subnetPrefixIPv6", 48);
+		ctx.deferAccept = conf.getNumber("HUB", "deferAccept");
 
 		ctx.cycleInputLimit = conf.getNumber("HUB", "cycleInputLimit", 8);
 		ctx.outputQueueLimit = conf.getNumber("HUB", "outputQueueLimit");
 		ctx.outputQueueLimit = Twiddler::min(ctx.outputQueueLimit,
 				Socket::OUT_QUEUE_SIZE - 1);
+		ctx.spillSize = conf.getNumber("HUB", "spillSize");
+		ctx.spillLimit = conf.getNumber("HUB", "spillLimit", 67108864);
+		ctx.spillPath = conf.getString("HUB", "spillPath", "/tmp");
+		ctx.scheduler = conf.getString("HUB", "scheduler", "none");
+		ctx.drrQuantum = conf.getNumber("HUB", "drrQuantum", Message::MTU);
+		ctx.drrClientWeight = conf.getNumber("HUB", "drrClientWeight", 1);
+		ctx.drrOverlayWeight = conf.getNumber("HUB", "drrOverlayWeight", 4);
+		ctx.drrPriorityWeight = conf.getNumber("HUB", "drrPriorityWeight",
+				8);
+		ctx.connectionMessageRate = conf.getNumber("HUB",
+				"connectionMessageRate");
+		ctx.connectionByteRate = conf.getNumber("HUB", "connectionByteRate");
+		ctx.groupMessageRate = conf.getNumber("HUB", "groupMessageRate");
+		ctx.groupByteRate = conf.getNumber("HUB", "groupByteRate");
+		ctx.uidMessageRate = conf.getNumber("HUB", "uidMessageRate");
+		ctx.uidByteRate = conf.getNumber("HUB", "uidByteRate");
+		ctx.rateBurst = conf.getNumber("HUB", "rateBurst", 1000);
+		ctx.rateDrop = conf.getBoolean("HUB", "rateDrop");
+
+		ctx.aqmTarget = conf.getNumber("HUB", "aqmTarget");
+		ctx.aqmInterval = conf.getNumber("HUB", "aqmInterval", 100);
 
 		ctx.throttle = conf.getBoolean("HUB", "throttle");
 		ctx.reservedMessages = conf.getNumber("HUB", "reservedMessages");
@@ -317,14 +359,23 @@ void Hub::configure(void *arg) {
 		ctx.verbosity = Logger::getDefault().getLevel();
 		//-----------------------------------------------------------------
 		WH_LOG_DEBUG(
-				"Hub setings:\n" "LISTEN=%s, BACKLOG=%d, SERVICENAME=%s, SERVICETYPE=%s,\n" "MAX_IO_EVENTS=%u, TIMER_EXPIRATION=%ums, TIMER_INTERVAL=%ums, SEMAPHORE=%s,\n" "SYNCHRONOUS_SIGNAL=%s, CONNECTION_POOL_SIZE=%u, MESSAGE_POOL_SIZE=%u,\n" "MAX_NEW_CONNECTIONS=%u, TMP_CONNECTION_TIMEOUT=%ums, CYCLEINLIMIT=%u,\n" "OUTQUEUELIMIT=%u THROTTLE=%s, RESERVED_MESSAGES=%u, ALLOW_PACKET_DROP=%s,\n" "MESSAGE_TTL=%u, ANSWER_RATIO=%f, FORWARD_RATIO=%f, LOG_LEVEL=%s\n",
+				"Hub setings:\n" "LISTEN=%s, BACKLOG=%d, SERVICENAME=%s, SERVICETYPE=%s,\n" "MAX_IO_EVENTS=%u, TIMER_EXPIRATION=%ums, TIMER_INTERVAL=%ums, SEMAPHORE=%s,\n" "SYNCHRONOUS_SIGNAL=%s, CONNECTION_POOL_SIZE=%u, MESSAGE_POOL_SIZE=%u,\n" "MAX_NEW_CONNECTIONS=%u, TMP_CONNECTION_TIMEOUT=%ums,\n" "ADDRESS_CONNECTIONS=%u/%u, SUBNET_CONNECTIONS=%u/%u, SUBNET_PREFIX=%u/%u,\n" "DEFER_ACCEPT=%us, CYCLEINLIMIT=%u,\n" "OUTQUEUELIMIT=%u, SPILL_SIZE=%u, SPILL_LIMIT=%llu, SPILL_PATH=%s, SCHEDULER=%s,\n" "DRR_QUANTUM=%u, DRR_WEIGHTS=%u/%u/%u, CONNECTION_RATE=%u/%u,\n" "GROUP_RATE=%u/%u, UID_RATE=%u/%u, RATE_BURST=%ums, RATE_DROP=%s,\n" "AQM_TARGET=%ums, AQM_INTERVAL=%ums, THROTTLE=%s,\n" "RESERVED_MESSAGES=%u, ALLOW_PACKET_DROP=%s,\n" "MESSAGE_TTL=%u, ANSWER_RATIO=%f, FORWARD_RATIO=%f, LOG_LEVEL=%s\n",
 				WH_BOOLF(ctx.listen), ctx.backlog, ctx.serviceName,
 				ctx.serviceType, ctx.maxIOEvents, ctx.timerExpiration,
 				ctx.timerInterval, WH_BOOLF(ctx.semaphore),
 				WH_BOOLF(ctx.signal), ctx.connectionPoolSize,
 				ctx.messagePoolSize, ctx.maxNewConnnections,
-				ctx.connectionTimeOut, ctx.cycleInputLimit,
-				ctx.outputQueueLimit, WH_BOOLF(ctx.throttle),
+				ctx.connectionTimeOut, ctx.addressConnections,
+				ctx.addressNewConnections, ctx.subnetConnections,
+				ctx.subnetNewConnections, ctx.subnetPrefixIPv4,
+				ctx.subnetPrefixIPv6, ctx.deferAccept, ctx.cycleInputLimit,
+				ctx.outputQueueLimit, ctx.spillSize, ctx.spillLimit,
+				ctx.spillPath, ctx.scheduler, ctx.drrQuantum, ctx.drrClientWeight,
+				ctx.drrOverlayWeight, ctx.drrPriorityWeight,
+				ctx.connectionMessageRate, ctx.connectionByteRate,
+				ctx.groupMessageRate, ctx.groupByteRate, ctx.uidMessageRate,
+				ctx.uidByteRate, ctx.rateBurst, WH_BOOLF(ctx.rateDrop),
+				ctx.aqmTarget, ctx.aqmInterval, WH_BOOLF(ctx.throttle),
 				ctx.reservedMessages, WH_BOOLF(ctx.allowPacketDrop),
 				ctx.messageTTL, ctx.answerRatio, ctx.forwardRatio,
 				Logger::describeLevel(Logger::getDefault().getLevel()));
@@ -336,6 +387,7 @@ void Hub::configure(void *arg) {
 		initReactor();
 		initListener();
 		initClock();
+		initAlarm();
 		initEventNotifier();
 		initInotifier();
 		initSignalWatcher();
@@ -361,6 +413,7 @@ void Hub::cleanup() noexcept {
 		//-----------------------------------------------------------------
 		//3. Clean up all the containers
 		temporaryConnections.clear();
+		starved.clear();
 		Message *msg;
 		while (outgoingMessages.get(msg)) {
 			Message::recycle(msg);
@@ -427,6 +480,10 @@ void Hub::processSignalNotification(unsigned long long uid,
 
 }
 
+bool Hub::isPrivileged(unsigned long long uid) const noexcept {
+	return false;
+}
+
 bool Hub::enableWorker() const noexcept {
 	return false;
 }
@@ -449,7 +506,9 @@ bool Hub::handle(Clock *clock) noexcept {
 			return disable(clock);
 		}
 		//-----------------------------------------------------------------
-		if (clock->getCount()) {
+		if (clock == notifiers.alarm) {
+			resumeConnections();
+		} else if (clock->getCount()) {
 			auto uid = (clock == notifiers.clock ? 0 : clock->getUid());
 			processClockNotification(uid, clock->getCount());
 		}
@@ -572,6 +631,7 @@ void Hub::setup(void *arg) {
 
 void Hub::loop() {
 	while (running) {
+		feedConnections();
 		monitor(outgoingMessages.isEmpty());
 		publish();
 		dispatch();
@@ -584,6 +644,31 @@ void Hub::initBuffers() {
 	try {
 		//Set up SSL/TLS
 		Socket::setSSLContext(getSSLContext());
+		//Set up the overflow of the outgoing queues
+		Socket::setSpillOptions(ctx.spillPath, ctx.spillSize, ctx.spillLimit);
+		//Set up the scheduling of the incoming messages
+		drr.setQuantum(ctx.drrQuantum);
+		drr.setWeights(ctx.drrClientWeight, ctx.drrOverlayWeight,
+				ctx.drrPriorityWeight);
+		if (ctx.scheduler && !strcasecmp(ctx.scheduler, "drr")) {
+			setScheduler(&drr);
+		}
+		//Set up the rate limits
+		limiter.setLimits(RATE_CONNECTION, ctx.connectionMessageRate,
+				ctx.connectionByteRate, ctx.rateBurst);
+		limiter.setLimits(RATE_GROUP, ctx.groupMessageRate, ctx.groupByteRate,
+				ctx.rateBurst);
+		limiter.setLimits(RATE_UID, ctx.uidMessageRate, ctx.uidByteRate,
+				ctx.rateBurst);
+		//Set up the admission control
+		admission.setLimits(ADMIT_ADDRESS, ctx.addressConnections,
+				ctx.addressNewConnections);
+		admission.setLimits(ADMIT_SUBNET, ctx.subnetConnections,
+				ctx.subnetNewConnections);
+		admission.setPrefixes(ctx.subnetPrefixIPv4, ctx.subnetPrefixIPv6);
+		//Set up the active queue management
+		CoDel::setOptions(ctx.aqmTarget, ctx.aqmInterval);
+		aqm.clear();
 		//Initialize the connections pool
 		Socket::initPool(ctx.connectionPoolSize);
 		//Initialize the message Pool
@@ -634,6 +719,9 @@ void Hub::initListener() {
 		}
 		//-----------------------------------------------------------------
 		listener = new Socket(serviceName, ctx.backlog, isUnixSocket);
+		if (ctx.deferAccept && !isUnixSocket) {
+			Network::setDeferAccept(listener->getHandle(), ctx.deferAccept);
+		}
 		listener->setUid(getUid());
 		putWatcher(listener, IO_READ, WATCHER_ACTIVE);
 		notifiers.listener = listener;
@@ -672,6 +760,30 @@ void Hub::initClock() {
 	}
 }
 
+void Hub::initAlarm() {
+	Clock *alarm = nullptr;
+	try {
+		alarmDeadline = 0;
+		if (limiter.isEnabled()) {
+			//Disarmed until a connection exceeds its rate limit
+			alarm = new Clock(0, 0);
+			putWatcher(alarm, IO_READ, WATCHER_ACTIVE);
+			notifiers.alarm = alarm;
+		} else {
+			notifiers.alarm = nullptr;
+			return;
+		}
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+		delete alarm;
+		throw;
+	} catch (...) {
+		WH_LOG_EXCEPTION_U();
+		delete alarm;
+		throw Exception(EX_ALLOCFAILED);
+	}
+}
+
 void Hub::initEventNotifier() {
 	EventNotifier *enotifier = nullptr;
 	try {
@@ -800,6 +912,21 @@ void Hub::publish() noexcept {
 			continue;
 		}
 		//-----------------------------------------------------------------
+		/*
+		 * Active queue management (CoDel), priority messages are exempt
+		 */
+		if (CoDel::isEnabled() && !msg->testFlags(MSG_PRIORITY)) {
+			//Time of dequeue, sampled per message (a cycle can be long)
+			auto now = Timer::timeStamp();
+			auto timestamp = msg->getTimestamp();
+			auto sojourn = (now > timestamp) ? (now - timestamp) : 0;
+			if (aqm.drop(sojourn, now, !outgoingMessages.isEmpty())) {
+				countDropped(msg->getLength());
+				Message::recycle(msg);
+				continue;
+			}
+		}
+		//-----------------------------------------------------------------
 		/*
 		 * Answer First Priority (AFP) and Random Drop
 		 */
@@ -814,22 +941,36 @@ void Hub::publish() noexcept {
 			continue;
 		}
 		//-----------------------------------------------------------------
-		if (!w->publish(msg)) {
+		if (w->publish(msg)) {
+			if (w->testEvents(IO_WRITE)) {
+				retain(w);
+			}
+		} else if (spill(w, msg)) {
+			//Recipient's queue is full, moved into the overflow file
+			Message::recycle(msg);
+			if (w->testEvents(IO_WRITE)) {
+				retain(w);
+			}
+		} else {
 			//Recipient's queue is full, retry later
 			incomingMessages.put(msg);
-		} else if (w->testEvents(IO_WRITE)) {
-			retain(w);
 		}
 	}
 }
 
 void Hub::processMessages() noexcept {
+	//Time of enqueue for the active queue management
+	auto now = CoDel::isEnabled() ? Timer::timeStamp() : 0;
 	Message *message;
 	while (incomingMessages.get(message)) {
 		if (!message->testFlags(MSG_PROCESSED)) {
 			//All the other flags are cleared
 			message->putFlags(MSG_PROCESSED);
 			route(message);
+			//Retried messages keep their original time stamp
+			if (now) {
+				message->setTimestamp(now);
+			}
 		}
 		outgoingMessages.put(message);
 	}
@@ -848,6 +989,11 @@ bool Hub::acceptConnection(Socket *listener) noexcept {
 		if (!newConn) {
 			//No more connections waiting
 			return false;
+		} else if (!admission.admit(newConn, Timer::timeStamp() / 1000)) {
+			WH_LOG_DEBUG("Connection %llu refused by the admission control",
+					newConn->getUid());
+			delete newConn;
+			return true;
 		}
 
 		//Announce the new arrival
@@ -865,6 +1011,7 @@ bool Hub::acceptConnection(Socket *listener) noexcept {
 		}
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
+		admission.remove(newConn);
 		delete newConn;
 	}
 	//We might be having more connections waiting
@@ -877,7 +1024,36 @@ bool Hub::processConnection(Socket *connection) noexcept {
 		//First drain out all the messages
 		if (connection->testEvents(IO_WRITE)
 				&& connection->testFlags(WATCHER_OUT)) {
+			auto messages = connection->messagesDropped();
+			auto bytes = connection->bytesDropped();
 			connection->write();
+			//Account for the messages dropped by the queue management
+			stats.msgDropped += (connection->messagesDropped() - messages);
+			stats.bytesDropped += (connection->bytesDropped() - bytes);
+			//Stop polling until the message pool frees up (see feedConnections)
+			int ret = 0;
+			if (connection->isStarved()
+					&& starved.put(connection, ret) == starved.end()) {
+				//Out of memory, keep polling
+				connection->setFlags(WATCHER_OUT);
+			}
+		}
+
+		/*
+		 * Rate limited connections skip reading until the alarm goes off. The
+		 * trusted connections are never limited (hence never dropped).
+		 */
+		auto now = (limiter.isEnabled() && !isPrivileged(connection->getUid())) ?
+				(Timer::timeStamp() / 1000) : 0;
+		unsigned int delay = 0;
+		if (now && (delay = limiter.check(connection, now))) {
+			if (ctx.rateDrop) {
+				return disable(connection);
+			} else {
+				delayConnections(delay);
+				return connection->testEvents(IO_WRITE)
+						&& connection->testFlags(WATCHER_OUT);
+			}
 		}
 
 		//Read from the socket
@@ -904,18 +1080,44 @@ bool Hub::processConnection(Socket *connection) noexcept {
 		 * Get all the messages from this connection
 		 */
 		unsigned int msgCount = 0;
-		while (msgCount < cycleLimit) {
+		auto admit = !scheduler || scheduler->start(connection);
+		auto idle = false;
+		while (admit && msgCount < cycleLimit) {
+			if (now && (delay = limiter.check(connection, now))) {
+				break;
+			}
+
 			Message *message = connection->getMessage();
 			if (message) {
 				incomingMessages.put(message);
 				countReceived(message->getLength());
 				msgCount++;
+				admit = !scheduler || scheduler->charge(connection, message);
+				if (now) {
+					limiter.charge(connection, message);
+				}
 			} else {
+				idle = true;
 				break;
 			}
 		}
+
+		if (scheduler) {
+			scheduler->stop(connection, idle);
+		}
+
+		if (delay) {
+			//Exceeded a rate limit
+			if (ctx.rateDrop) {
+				return disable(connection);
+			} else {
+				delayConnections(delay);
+				return connection->testEvents(IO_WRITE)
+						&& connection->testFlags(WATCHER_OUT);
+			}
+		}
 		//-----------------------------------------------------------------
-		return connection->isReady()
+		return connection->isReady() || !admit
 				|| (ctx.cycleInputLimit && (msgCount == cycleLimit));
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
@@ -953,6 +1155,69 @@ unsigned int Hub::throttle(const Socket *connection) const noexcept {
 	}
 }
 
+bool Hub::spill(Watcher *w, const Message *message) noexcept {
+	//Only the connections can hold on to the messages
+	if (!w || w == notifiers.clock || w == notifiers.enotifier
+			|| w == notifiers.inotifier || w == notifiers.signalWatcher
+			|| w == notifiers.alarm) {
+		return false;
+	} else {
+		return static_cast<Socket*>(w)->spill(message);
+	}
+}
+
+void Hub::delayConnections(unsigned int delay) noexcept {
+	auto deadline = (Timer::timeStamp() / 1000) + delay;
+	if (!notifiers.alarm || (alarmDeadline && alarmDeadline <= deadline)) {
+		return;
+	}
+
+	try {
+		notifiers.alarm->reset(delay, 0);
+		alarmDeadline = deadline;
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+void Hub::resumeConnections() noexcept {
+	alarmDeadline = 0;
+	auto next = limiter.resume(Timer::timeStamp() / 1000, resumeConnection,
+			this);
+	if (next) {
+		delayConnections(next);
+	}
+}
+
+void Hub::resumeConnection(Socket *connection, void *arg) noexcept {
+	static_cast<Hub*>(arg)->retain(connection);
+}
+
+void Hub::feedConnections() noexcept {
+	Feed feed { this, Message::unallocated() };
+	if (feed.messages && starved.size()) {
+		starved.iterate(feedConnection, &feed);
+	}
+}
+
+int Hub::feedConnection(unsigned int index, void *arg) noexcept {
+	auto feed = static_cast<Feed*>(arg);
+	if (!feed->messages) {
+		return -1;
+	}
+
+	const Socket *s = nullptr;
+	feed->hub->starved.getKey(index, s);
+	auto connection = const_cast<Socket*>(s);
+	//Each resumed connection is budgeted one free message
+	connection->setFlags(WATCHER_OUT);
+	if (connection->testEvents(IO_WRITE)) {
+		feed->hub->retain(connection);
+	}
+	--feed->messages;
+	return 1;
+}
+
 void Hub::countReceived(unsigned int bytes) noexcept {
 	stats.msgReceived += 1;
 	stats.bytesReceived += bytes;
@@ -969,6 +1234,7 @@ void Hub::clear() noexcept {
 	memset(&notifiers, 0, sizeof(notifiers));
 	memset(&ctx, 0, sizeof(ctx));
 	workerThread = nullptr;
+	scheduler = nullptr;
 }
 
 int Hub::deleteWatchers(Watcher *w, void *arg) noexcept {
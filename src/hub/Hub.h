@@ -12,15 +12,21 @@
 
 #ifndef WH_HUB_HUB_H_
 #define WH_HUB_HUB_H_
+#include "Admission.h"
 #include "Clock.h"
+#include "CoDel.h"
+#include "DeficitRoundRobin.h"
 #include "EventNotifier.h"
 #include "Inotifier.h"
+#include "RateLimiter.h"
 #include "SignalWatcher.h"
 #include "Socket.h"
 #include "../base/Timer.h"
 #include "../base/Thread.h"
 #include "../base/ds/Buffer.h"
 #include "../base/ds/CircularBuffer.h"
+#include "../base/ds/Khash.h"
+#include "../base/ds/Twiddler.h"
 #include "../reactor/Handler.h"
 #include "../reactor/Reactor.h"
 #include "../reactor/Watchers.h"
@@ -144,8 +150,17 @@ protected:
 	 */
 	//Inserts a newly created  message directly into the incoming queue
 	bool retainMessage(Message *message) noexcept;
-	//Inserts a newly created message directly into the outgoing queue
+	/*
+	 * Inserts a newly created message directly into the outgoing queue, the
+	 * MSG_PRIORITY flag is preserved.
+	 */
 	bool sendMessage(Message *message) noexcept;
+	/*
+	 * Installs the policy which schedules the incoming messages of the
+	 * connections, nullptr restores the default (round-robin limited by
+	 * the cycleInputLimit). The <scheduler> must outlive the hub's loop.
+	 */
+	void setScheduler(Scheduler *scheduler) noexcept;
 	//=================================================================
 	/**
 	 * Implementation of the Reactor interface
@@ -191,6 +206,8 @@ private:
 	//Callback for the signal notification, <uid> is the source identifier
 	virtual void processSignalNotification(unsigned long long uid,
 			const SignalInfo *info) noexcept;
+	//Return true if the connection <uid> is trusted (exempt from the rate limits)
+	virtual bool isPrivileged(unsigned long long uid) const noexcept;
 
 	//Return true to allow creation of the worker thread
 	virtual bool enableWorker() const noexcept;
@@ -234,6 +251,7 @@ private:
 	void initReactor();
 	void initListener();
 	void initClock();
+	void initAlarm();
 	void initEventNotifier();
 	void initInotifier();
 	void initSignalWatcher();
@@ -269,6 +287,16 @@ private:
 	bool dropMessage(Message *message) const noexcept;
 	//Sets admission limit (congestion control)
 	unsigned int throttle(const Socket *connection) const noexcept;
+	//Moves the <message> into the overflow file of the connection <w>
+	bool spill(Watcher *w, const Message *message) noexcept;
+	//Arms the alarm to resume the rate limited connections after <delay> ms
+	void delayConnections(unsigned int delay) noexcept;
+	//Resumes the rate limited connections whose delay has elapsed
+	void resumeConnections() noexcept;
+	static void resumeConnection(Socket *connection, void *arg) noexcept;
+	//Resumes the starved connections as the message pool frees up
+	void feedConnections() noexcept;
+	static int feedConnection(unsigned int index, void *arg) noexcept;
 	void countReceived(unsigned int bytes) noexcept;
 	void countDropped(unsigned int bytes) noexcept;
 	//=================================================================
@@ -276,6 +304,24 @@ private:
 	void clear() noexcept;
 	//Iterate through internal record and delete all the watchers
 	static int deleteWatchers(Watcher *w, void *arg) noexcept;
+private:
+	//Argument of the starved connections' callback
+	struct Feed {
+		Hub *hub;
+		unsigned int messages;
+	};
+
+	struct HFN {
+		unsigned int operator()(const Socket *s) const noexcept {
+			return Twiddler::mix((unsigned long long) s);
+		}
+	};
+
+	struct EQFN {
+		bool operator()(const Socket *s1, const Socket *s2) const noexcept {
+			return (s1 == s2);
+		}
+	};
 private:
 	//Hub's unique identifier
 	const unsigned long long uid;
@@ -292,6 +338,12 @@ private:
 	CircularBuffer<Message*> outgoingMessages;
 	//List of incoming temporary connections
 	Buffer<unsigned long long> temporaryConnections;
+	//Scheduling policy of the incoming messages (nullptr for the default)
+	Scheduler *scheduler;
+	//Built-in deficit round-robin scheduler
+	DeficitRoundRobin drr;
+	//Active queue management of the outgoing messages
+	CoDel aqm;
 	//-----------------------------------------------------------------
 	/*
 	 * Hub statistics
@@ -313,7 +365,16 @@ private:
 		EventNotifier *enotifier; //Events watcher
 		Inotifier *inotifier;	//File system watcher
 		SignalWatcher *signalWatcher; //Signal watcher
+		Clock *alarm; //Resumes the rate limited connections
 	} notifiers;
+	//Expiration time of the alarm in milliseconds (0 if disarmed)
+	unsigned long long alarmDeadline;
+	//Token bucket rate limits of the incoming messages
+	RateLimiter limiter;
+	//Per source address limits of the incoming connections
+	Admission admission;
+	//Connections whose spilled messages are waiting for the message pool
+	Khash<const Socket*, char, false, HFN, EQFN> starved;
 	//-----------------------------------------------------------------
 	/*
 	 * Hub configuration
@@ -345,11 +406,51 @@ private:
 		unsigned int maxNewConnnections;
 		//Time-out for temporary connections in miliseconds
 		unsigned int connectionTimeOut;
+		//Concurrent and recent connections per source address (0 for no limit)
+		unsigned int addressConnections;
+		unsigned int addressNewConnections;
+		//Concurrent and recent connections per subnet (0 for no limit)
+		unsigned int subnetConnections;
+		unsigned int subnetNewConnections;
+		//Prefix lengths of the IPv4 and IPv6 subnets
+		unsigned int subnetPrefixIPv4;
+		unsigned int subnetPrefixIPv6;
+		//TCP_DEFER_ACCEPT on the listener in seconds (0 to disable)
+		unsigned int deferAccept;
 
 		//Limit on incoming messages from each connection each cycle
 		unsigned int cycleInputLimit;
 		//Limit on outgoing messages a connection is allowed to hold on to
 		unsigned int outputQueueLimit;
+		//Size of a connection's overflow file in bytes (0 to disable)
+		unsigned int spillSize;
+		//Total size of the overflow files in bytes
+		unsigned long long spillLimit;
+		//Directory for the overflow files
+		const char *spillPath;
+		//Scheduling policy of the incoming messages ("drr" or none)
+		const char *scheduler;
+		//Deficit round-robin: bytes per turn of a connection of unit weight
+		unsigned int drrQuantum;
+		//Deficit round-robin: weights of the connection classes
+		unsigned int drrClientWeight;
+		unsigned int drrOverlayWeight;
+		unsigned int drrPriorityWeight;
+		//Rate limits in messages and bytes per second (0 for no limit)
+		unsigned int connectionMessageRate;
+		unsigned int connectionByteRate;
+		unsigned int groupMessageRate;
+		unsigned int groupByteRate;
+		unsigned int uidMessageRate;
+		unsigned int uidByteRate;
+		//Burst size of the rate limits in milliseconds worth of traffic
+		unsigned int rateBurst;
+		//Disconnect (instead of delay) the connections exceeding a rate limit
+		bool rateDrop;
+		//CoDel: target sojourn time of the queued messages (0 to disable)
+		unsigned int aqmTarget;
+		//CoDel: interval in milliseconds
+		unsigned int aqmInterval;
 		//Throttle incoming packets under load
 		bool throttle;
 		//These number of messages will be reserved for internal purposes
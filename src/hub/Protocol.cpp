@@ -11,6 +11,7 @@
  */
 
 #include "Protocol.h"
+#include "Topic.h"
 #include "../base/ds/Serializer.h"
 #include "../util/commands.h"
 
@@ -176,86 +177,81 @@ bool Protocol::bootstrapRequest(uint64_t id, uint64_t keys[], uint32_t &limit) {
 			&& processBootstrapResponse(keys, limit);
 }
 
-unsigned int Protocol::createPublishRequest(uint64_t id, uint8_t topic,
+unsigned int Protocol::createPublishRequest(uint64_t id, uint32_t topic,
 		const unsigned char *payload, unsigned int payloadLength) noexcept {
-	if ((payloadLength && !payload) || payloadLength > Message::PAYLOAD_SIZE) {
+	auto extended = (topic > Topic::MAX_ID);
+	auto offset = extended ? sizeof(uint32_t) : 0;
+	if ((payloadLength && !payload)
+			|| payloadLength > (Message::PAYLOAD_SIZE - offset)) {
 		return 0;
 	} else {
-		header().load(getSource(), id, Message::HEADER_SIZE + payloadLength,
-				nextSequenceNumber(), topic, WH_CMD_MULTICAST, WH_QLF_PUBLISH,
-				WH_AQLF_REQUEST);
+		header().load(getSource(), id,
+				Message::HEADER_SIZE + offset + payloadLength,
+				nextSequenceNumber(), extended ? 0 : topic, WH_CMD_MULTICAST,
+				extended ? WH_QLF_XPUBLISH : WH_QLF_PUBLISH, WH_AQLF_REQUEST);
 		auto len = header().serialize(buffer());
+		if (extended) {
+			Serializer::packi32(buffer(len), topic);
+		}
 		if (payload) {
-			Serializer::packib(buffer(len), payload, payloadLength);
+			Serializer::packib(buffer(len + offset), payload, payloadLength);
 		}
 		return header().getLength();
 	}
 }
 
-bool Protocol::publishRequest(uint64_t id, uint8_t topic,
+bool Protocol::publishRequest(uint64_t id, uint32_t topic,
 		const unsigned char *payload, unsigned int payloadLength) {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=0, AQLF=0/1/127
-	 * BODY: variable in Request; no Response
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=0/3, AQLF=0/1/127
+	 * BODY: variable in Request (4 bytes as <topic> first if QLF=3); no Response
 	 * TOTAL: at least 32 bytes in Request; no Response
 	 */
 	return createPublishRequest(id, topic, payload, payloadLength)
 			&& (send(), true);
 }
 
-unsigned int Protocol::createSubscribeRequest(uint64_t id,
-		uint8_t topic) noexcept {
-	header().load(getSource(), id, Message::HEADER_SIZE, nextSequenceNumber(),
-			topic, WH_CMD_MULTICAST, WH_QLF_SUBSCRIBE, WH_AQLF_REQUEST);
-	header().serialize(buffer());
-	return header().getLength();
+unsigned int Protocol::createSubscribeRequest(uint64_t id, uint32_t topic,
+		const TopicFilter *filter, const Conflation *conflation) noexcept {
+	return createTopicRequest(id, topic, WH_QLF_SUBSCRIBE, WH_QLF_XSUBSCRIBE,
+			filter, conflation);
 }
 
-unsigned int Protocol::processSubscribeResponse(uint8_t topic) const noexcept {
-	if (!checkCommand(WH_CMD_MULTICAST, WH_QLF_SUBSCRIBE)) {
-		return 0;
-	} else if (getHeader().getLength() == Message::HEADER_SIZE
-			&& getHeader().getSession() == topic) {
-		return getHeader().getLength();
-	} else {
-		return 0;
-	}
+unsigned int Protocol::processSubscribeResponse(uint32_t topic) const noexcept {
+	return processTopicResponse(topic, WH_QLF_SUBSCRIBE, WH_QLF_XSUBSCRIBE);
 }
 
-bool Protocol::subscribeRequest(uint64_t id, uint8_t topic) {
+bool Protocol::subscribeRequest(uint64_t id, uint32_t topic,
+		const TopicFilter *filter, const Conflation *conflation) {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=1, AQLF=0/1/127
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=1/4, AQLF=0/1/127
 	 * BODY: 0 in Request; 0 in Response
+	 * If QLF=4: 4 bytes as <topic> + optional 20 bytes as <filter> + optional
+	 * 4 bytes as <conflation> in Request; 4 bytes as <topic> in Response
 	 * TOTAL: 32 bytes in Request; 32 bytes in Response
+	 * If QLF=4: 36, 56 or 60 bytes in Request; 36 bytes in Response
 	 */
-	return createSubscribeRequest(id, topic) && executeRequest()
+	return createSubscribeRequest(id, topic, filter, conflation)
+			&& executeRequest()
 			&& processSubscribeResponse(topic);
 }
 
 unsigned int Protocol::createUnsubscribeRequest(uint64_t id,
-		uint8_t topic) noexcept {
-	header().load(getSource(), id, Message::HEADER_SIZE, nextSequenceNumber(),
-			topic, WH_CMD_MULTICAST, WH_QLF_UNSUBSCRIBE, WH_AQLF_REQUEST);
-	header().serialize(buffer());
-	return header().getLength();
+		uint32_t topic) noexcept {
+	return createTopicRequest(id, topic, WH_QLF_UNSUBSCRIBE,
+			WH_QLF_XUNSUBSCRIBE);
 }
 
-unsigned int Protocol::processUnsubscribeResponse(uint8_t topic) const noexcept {
-	if (!checkCommand(WH_CMD_MULTICAST, WH_QLF_UNSUBSCRIBE)) {
-		return 0;
-	} else if (getHeader().getLength() == Message::HEADER_SIZE
-			&& getHeader().getSession() == topic) {
-		return getHeader().getLength();
-	} else {
-		return 0;
-	}
+unsigned int Protocol::processUnsubscribeResponse(
+		uint32_t topic) const noexcept {
+	return processTopicResponse(topic, WH_QLF_UNSUBSCRIBE, WH_QLF_XUNSUBSCRIBE);
 }
 
-bool Protocol::unsubscribeRequest(uint64_t id, uint8_t topic) {
+bool Protocol::unsubscribeRequest(uint64_t id, uint32_t topic) {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=2, AQLF=0/1/127
-	 * BODY: 0 in Request; 0 in Response
-	 * TOTAL: 32 bytes in Request; 32 bytes in Response
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=2/5, AQLF=0/1/127
+	 * BODY: 0 in Request; 0 in Response (4 bytes as <topic> if QLF=5)
+	 * TOTAL: 32 bytes in Request; 32 bytes in Response (36 bytes if QLF=5)
 	 */
 	return createUnsubscribeRequest(id, topic) && executeRequest()
 			&& processUnsubscribeResponse(topic);
@@ -501,6 +497,58 @@ unsigned int Protocol::processGetKeyResponse(const Message *msg,
 	}
 }
 
+unsigned int Protocol::createResumeRequest(uint64_t host, uint64_t uid,
+		uint16_t sequenceNumber, const unsigned char *token,
+		unsigned int length, const PKIEncryptedData *proof,
+		MessageHeader &header, unsigned char *buf) noexcept {
+	if (!buf || !proof || (length && !token)
+			|| length > (Message::PAYLOAD_SIZE - PKI::ENCRYPTED_LENGTH)) {
+		return 0;
+	} else {
+		auto len = Message::HEADER_SIZE + length + PKI::ENCRYPTED_LENGTH;
+		header.load(uid, host, len, sequenceNumber, 0, WH_CMD_BASIC,
+				WH_QLF_RESUME, WH_AQLF_REQUEST);
+		header.serialize(buf);
+		if (length) {
+			Serializer::packib(buf + Message::HEADER_SIZE, token, length);
+		}
+		Serializer::packib(buf + Message::HEADER_SIZE + length,
+				(const unsigned char*) proof, PKI::ENCRYPTED_LENGTH);
+		return len;
+	}
+}
+
+Message* Protocol::createResumeRequest(uint64_t host, uint64_t uid,
+		uint16_t sequenceNumber, const unsigned char *token,
+		unsigned int length, const PKIEncryptedData *proof) noexcept {
+	auto msg = Message::create();
+	if (!msg) {
+		return nullptr;
+	} else if (!createResumeRequest(host, uid, sequenceNumber, token, length,
+			proof, msg->getHeader(), msg->getStorage())) {
+		Message::recycle(msg);
+		return nullptr;
+	} else {
+		msg->updateLength(msg->getHeader().getLength());
+		return msg;
+	}
+}
+
+unsigned int Protocol::processResumeResponse(const Message *msg,
+		unsigned int &length, const unsigned char *&token) noexcept {
+	if (!msg || !msg->validate()) {
+		return 0;
+	} else if (!(msg->getCommand() == WH_CMD_BASIC
+			&& msg->getQualifier() == WH_QLF_RESUME
+			&& msg->getStatus() == WH_AQLF_ACCEPTED)) {
+		return 0;
+	} else {
+		length = msg->getPayloadLength();
+		token = length ? msg->getBytes(0) : nullptr;
+		return msg->getLength();
+	}
+}
+
 unsigned int Protocol::createFindRootRequest(uint64_t host, uint64_t uid,
 		uint64_t identity, uint16_t sequenceNumber, MessageHeader &header,
 		unsigned char *buf) noexcept {
@@ -564,4 +612,55 @@ unsigned int Protocol::processFindRootResponse(const Message *msg,
 	}
 }
 
+unsigned int Protocol::createTopicRequest(uint64_t id, uint32_t topic,
+		uint8_t qualifier, uint8_t xQualifier, const TopicFilter *filter,
+		const Conflation *conflation) noexcept {
+	auto conflated = conflation && conflation->isEnabled();
+	//The filter precedes the conflation settings
+	auto filtered = conflated || (filter && !filter->isEmpty());
+	if (topic > Topic::MAX_ID || filtered) {
+		auto length = Message::HEADER_SIZE + sizeof(uint32_t)
+				+ (filtered ? TopicFilter::SIZE : 0)
+				+ (conflated ? Conflation::SIZE : 0);
+		header().load(getSource(), id, length, nextSequenceNumber(), 0,
+				WH_CMD_MULTICAST, xQualifier, WH_AQLF_REQUEST);
+		auto len = header().serialize(buffer());
+		Serializer::packi32(buffer(len), topic);
+		len += sizeof(uint32_t);
+		if (filtered) {
+			TopicFilter none;
+			none.clear();
+			len += (filter ? filter : &none)->pack(buffer(len));
+		}
+		if (conflated) {
+			conflation->pack(buffer(len));
+		}
+	} else {
+		header().load(getSource(), id, Message::HEADER_SIZE,
+				nextSequenceNumber(), topic, WH_CMD_MULTICAST, qualifier,
+				WH_AQLF_REQUEST);
+		header().serialize(buffer());
+	}
+	return header().getLength();
+}
+
+unsigned int Protocol::processTopicResponse(uint32_t topic, uint8_t qualifier,
+		uint8_t xQualifier) const noexcept {
+	if (checkCommand(WH_CMD_MULTICAST, xQualifier)) {
+		if (getHeader().getLength() == Message::HEADER_SIZE + sizeof(uint32_t)
+				&& Serializer::unpacku32(getPayload(0)) == topic) {
+			return getHeader().getLength();
+		} else {
+			return 0;
+		}
+	} else if (!checkCommand(WH_CMD_MULTICAST, qualifier)) {
+		return 0;
+	} else if (getHeader().getLength() == Message::HEADER_SIZE
+			&& getHeader().getSession() == topic) {
+		return getHeader().getLength();
+	} else {
+		return 0;
+	}
+}
+
 } /* namespace wanhive */
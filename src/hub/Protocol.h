@@ -12,6 +12,8 @@
 
 #ifndef WH_HUB_PROTOCOL_H_
 #define WH_HUB_PROTOCOL_H_
+#include "Conflation.h"
+#include "TopicFilter.h"
 #include "../util/Endpoint.h"
 
 namespace wanhive {
@@ -93,27 +95,37 @@ public:
 	/**
 	 * Bare minimum pub/sub protocol
 	 * <id> = identifier of the remote host
+	 * Topics above Topic::MAX_ID are carried in the first four bytes of the
+	 * payload (extended qualifiers), the smaller ones in the session field.
+	 * The optional subscription <filter> is evaluated by the hub on the
+	 * payload of every publication (following the topic if extended). The
+	 * optional <conflation> lets the hub replace the queued publications when
+	 * the subscriber falls behind.
 	 */
 	//Returns the message length on success, 0 on error
-	unsigned int createPublishRequest(uint64_t id, uint8_t topic,
+	unsigned int createPublishRequest(uint64_t id, uint32_t topic,
 			const unsigned char *payload, unsigned int payloadLength) noexcept;
 	//Always returns true
-	bool publishRequest(uint64_t id, uint8_t topic,
+	bool publishRequest(uint64_t id, uint32_t topic,
 			const unsigned char *payload, unsigned int payloadLength);
 
 	//Returns the message length on success, 0 on error
-	unsigned int createSubscribeRequest(uint64_t id, uint8_t topic) noexcept;
+	unsigned int createSubscribeRequest(uint64_t id, uint32_t topic,
+			const TopicFilter *filter = nullptr,
+			const Conflation *conflation = nullptr) noexcept;
 	//Returns the message length on success, 0 on error
-	unsigned int processSubscribeResponse(uint8_t topic) const noexcept;
+	unsigned int processSubscribeResponse(uint32_t topic) const noexcept;
 	//Returns true on success, false otherwise
-	bool subscribeRequest(uint64_t id, uint8_t topic);
+	bool subscribeRequest(uint64_t id, uint32_t topic,
+			const TopicFilter *filter = nullptr,
+			const Conflation *conflation = nullptr);
 
 	//Returns the message length on success, 0 on error
-	unsigned int createUnsubscribeRequest(uint64_t id, uint8_t topic) noexcept;
+	unsigned int createUnsubscribeRequest(uint64_t id, uint32_t topic) noexcept;
 	//Returns the message length on success, 0 on error
-	unsigned int processUnsubscribeResponse(uint8_t topic) const noexcept;
+	unsigned int processUnsubscribeResponse(uint32_t topic) const noexcept;
 	//Returns true on success, false otherwise
-	bool unsubscribeRequest(uint64_t id, uint8_t topic);
+	bool unsubscribeRequest(uint64_t id, uint32_t topic);
 	//-----------------------------------------------------------------
 	/**
 	 * STATIC METHODS
@@ -179,6 +191,22 @@ public:
 	static unsigned int processGetKeyResponse(const Message *msg,
 			Digest *hc) noexcept;
 
+	/*
+	 * Returns message length on success, 0 on failure. The <proof> of the
+	 * client's secret follows the <token>, empty <token> requests one.
+	 */
+	static unsigned int createResumeRequest(uint64_t host, uint64_t uid,
+			uint16_t sequenceNumber, const unsigned char *token,
+			unsigned int length, const PKIEncryptedData *proof,
+			MessageHeader &header, unsigned char *buf) noexcept;
+	//Returns a new message on success, nullptr on failure
+	static Message* createResumeRequest(uint64_t host, uint64_t uid,
+			uint16_t sequenceNumber, const unsigned char *token,
+			unsigned int length, const PKIEncryptedData *proof) noexcept;
+	//Returns message length on success, 0 on failure (token's <length> can be 0)
+	static unsigned int processResumeResponse(const Message *msg,
+			unsigned int &length, const unsigned char *&token) noexcept;
+
 	//Returns message length on success, 0 on failure
 	static unsigned int createFindRootRequest(uint64_t host, uint64_t uid,
 			uint64_t identity, uint16_t sequenceNumber, MessageHeader &header,
@@ -193,6 +221,14 @@ public:
 	//Returns message length on success, 0 on failure
 	static unsigned int processFindRootResponse(const Message *msg,
 			uint64_t identity, uint64_t &root) noexcept;
+private:
+	//Subscription management, picks the extended <xQualifier> if required
+	unsigned int createTopicRequest(uint64_t id, uint32_t topic,
+			uint8_t qualifier, uint8_t xQualifier,
+			const TopicFilter *filter = nullptr,
+			const Conflation *conflation = nullptr) noexcept;
+	unsigned int processTopicResponse(uint32_t topic, uint8_t qualifier,
+			uint8_t xQualifier) const noexcept;
 };
 
 } /* namespace wanhive */
@@ -0,0 +1,215 @@
+/*
+ * RateLimiter.cpp
+ *
+ * Token bucket rate limits of the incoming messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "RateLimiter.h"
+#include "Socket.h"
+#include <cstring>
+
+namespace wanhive {
+
+RateLimiter::RateLimiter() noexcept {
+	memset(limits, 0, sizeof(limits));
+	for (unsigned int i = 0; i < GROUPS; ++i) {
+		reset(groups[i], RATE_GROUP);
+	}
+}
+
+RateLimiter::~RateLimiter() {
+
+}
+
+void RateLimiter::setLimits(RateScope scope, unsigned int messages,
+		unsigned int bytes, unsigned int burst) noexcept {
+	limits[scope].messages = messages;
+	limits[scope].bytes = bytes;
+	limits[scope].burst = burst;
+	clear();
+}
+
+bool RateLimiter::isEnabled() const noexcept {
+	for (auto &l : limits) {
+		if (l.messages || l.bytes) {
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int RateLimiter::check(Socket *connection,
+		unsigned long long now) noexcept {
+	if (isExempt(connection)) {
+		return 0;
+	}
+
+	auto i = connections.get(connection);
+	if (i == connections.end()) {
+		int ret = 0;
+		Connection c;
+		reset(c.buckets, RATE_CONNECTION);
+		c.deadline = 0;
+		if ((i = connections.put(connection, ret)) == connections.end()
+				|| !connections.setValue(i, c)) {
+			//Fail open
+			return 0;
+		}
+	}
+
+	auto c = connections.getValueReference(i);
+	auto delay = update(c->buckets, now);
+	Buckets *b = nullptr;
+	unsigned int d = 0;
+	if ((b = getGroup(connection))) {
+		d = update(*b, now);
+		delay = (d > delay) ? d : delay;
+	}
+
+	if (!Socket::isEphemeralId(connection->getUid())
+			&& (b = getBuckets(connection->getUid(), true, now))) {
+		d = update(*b, now);
+		delay = (d > delay) ? d : delay;
+	}
+
+	c->deadline = delay ? (now + delay) : 0;
+	return delay;
+}
+
+void RateLimiter::charge(const Socket *connection,
+		const Message *message) noexcept {
+	if (isExempt(connection)) {
+		return;
+	}
+
+	auto bytes = message->getLength();
+	auto c = connections.getValueReference(connections.get(connection));
+	if (c) {
+		consume(c->buckets, bytes);
+	}
+
+	Buckets *b = nullptr;
+	if ((b = getGroup(connection))) {
+		consume(*b, bytes);
+	}
+
+	if (!Socket::isEphemeralId(connection->getUid())
+			&& (b = getBuckets(connection->getUid(), false, 0))) {
+		consume(*b, bytes);
+	}
+}
+
+unsigned int RateLimiter::resume(unsigned long long now,
+		void (*fn)(Socket *connection, void *arg), void *arg) noexcept {
+	Resumption r { this, now, 0, fn, arg };
+	connections.iterate(resumeCallback, &r);
+	return (unsigned int) r.next;
+}
+
+void RateLimiter::remove(const Socket *connection) noexcept {
+	connections.removeKey(connection);
+}
+
+void RateLimiter::clear() noexcept {
+	connections.clear();
+	uids.clear();
+	for (unsigned int i = 0; i < GROUPS; ++i) {
+		reset(groups[i], RATE_GROUP);
+	}
+}
+
+bool RateLimiter::isExempt(const Socket *connection) noexcept {
+	return connection->testFlags(SOCKET_PRIORITY | SOCKET_OVERLAY);
+}
+
+void RateLimiter::reset(Buckets &buckets, RateScope scope) const noexcept {
+	auto &l = limits[scope];
+	buckets.messages.set(l.messages,
+			(unsigned int) (((unsigned long long) l.messages * l.burst) / 1000));
+	buckets.bytes.set(l.bytes,
+			(unsigned int) (((unsigned long long) l.bytes * l.burst) / 1000));
+}
+
+RateLimiter::Buckets* RateLimiter::getGroup(
+		const Socket *connection) noexcept {
+	//Group 0 holds all the unregistered connections, sharing would starve them
+	auto group = connection->getGroup();
+	return group ? &groups[group] : nullptr;
+}
+
+RateLimiter::Buckets* RateLimiter::getBuckets(unsigned long long uid,
+		bool create, unsigned long long now) noexcept {
+	if (!limits[RATE_UID].messages && !limits[RATE_UID].bytes) {
+		return nullptr;
+	}
+
+	auto i = uids.get(uid);
+	if (i == uids.end()) {
+		if (!create) {
+			return nullptr;
+		} else if (uids.size() >= 2 * connections.size() + 16) {
+			expire(now);
+		}
+
+		int ret = 0;
+		Buckets b;
+		reset(b, RATE_UID);
+		if ((i = uids.put(uid, ret)) == uids.end() || !uids.setValue(i, b)) {
+			return nullptr;
+		}
+	}
+	return uids.getValueReference(i);
+}
+
+unsigned int RateLimiter::update(Buckets &buckets,
+		unsigned long long now) noexcept {
+	buckets.messages.update(now);
+	buckets.bytes.update(now);
+	auto m = buckets.messages.delay();
+	auto b = buckets.bytes.delay();
+	return (m > b) ? m : b;
+}
+
+void RateLimiter::consume(Buckets &buckets, unsigned int bytes) noexcept {
+	buckets.messages.consume(1);
+	buckets.bytes.consume(bytes);
+}
+
+void RateLimiter::expire(unsigned long long now) noexcept {
+	Expiry expiry { this, now };
+	uids.iterate(expireCallback, &expiry);
+}
+
+int RateLimiter::resumeCallback(unsigned int index, void *arg) noexcept {
+	auto r = static_cast<Resumption*>(arg);
+	auto c = r->limiter->connections.getValueReference(index);
+	if (!c->deadline) {
+		return 0;
+	} else if (c->deadline <= r->now) {
+		c->deadline = 0;
+		const Socket *s = nullptr;
+		r->limiter->connections.getKey(index, s);
+		r->fn(const_cast<Socket*>(s), r->arg);
+		return 0;
+	} else {
+		auto wait = c->deadline - r->now;
+		r->next = (!r->next || wait < r->next) ? wait : r->next;
+		return 0;
+	}
+}
+
+int RateLimiter::expireCallback(unsigned int index, void *arg) noexcept {
+	auto expiry = static_cast<Expiry*>(arg);
+	auto b = expiry->limiter->uids.getValueReference(index);
+	update(*b, expiry->now);
+	//Full buckets carry no information
+	return (b->messages.isFull() && b->bytes.isFull()) ? 1 : 0;
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,144 @@
+/*
+ * RateLimiter.h
+ *
+ * Token bucket rate limits of the incoming messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_RATELIMITER_H_
+#define WH_HUB_RATELIMITER_H_
+#include "TokenBucket.h"
+#include "../base/ds/Khash.h"
+
+namespace wanhive {
+class Message;
+class Socket;
+
+enum RateScope {
+	RATE_CONNECTION, //Each connection
+	RATE_GROUP, //Connections sharing a group ID
+	RATE_UID //Connections registered with the same identifier
+};
+/**
+ * Limits the incoming messages in messages per second and in bytes per
+ * second at several scopes. A connection which exceeds any one of the limits
+ * is delayed until the exhausted bucket refills. The state of the registered
+ * identifiers outlives their connections, reconnecting doesn't reset the
+ * limits. The priority and overlay connections are exempt. The group limits
+ * don't apply to group 0 (the unregistered connections and the clients
+ * without a group).
+ * Thread safe at class level
+ */
+class RateLimiter {
+public:
+	RateLimiter() noexcept;
+	~RateLimiter();
+	//-----------------------------------------------------------------
+	/*
+	 * Sets the limits of the <scope>: <messages> per second and <bytes> per
+	 * second (zero disables the limit). The buckets can hold <burst>
+	 * milliseconds worth of tokens. Resets the existing state.
+	 */
+	void setLimits(RateScope scope, unsigned int messages, unsigned int bytes,
+			unsigned int burst) noexcept;
+	//Returns true if any one of the limits is set
+	bool isEnabled() const noexcept;
+	//-----------------------------------------------------------------
+	/*
+	 * Returns zero (0) if the <connection> may deliver another message at time
+	 * <now> (in milliseconds), otherwise the delay in milliseconds.
+	 */
+	unsigned int check(Socket *connection, unsigned long long now) noexcept;
+	//Accounts for the <message> delivered by the <connection>
+	void charge(const Socket *connection, const Message *message) noexcept;
+	/*
+	 * Calls <fn> for every delayed connection whose delay has elapsed at time
+	 * <now>. Returns the time in milliseconds until the next delay elapses,
+	 * zero (0) if no connection is waiting.
+	 */
+	unsigned int resume(unsigned long long now,
+			void (*fn)(Socket *connection, void *arg), void *arg) noexcept;
+	//Forgets the <connection>
+	void remove(const Socket *connection) noexcept;
+	//Releases all the state
+	void clear() noexcept;
+private:
+	struct Buckets {
+		TokenBucket messages;
+		TokenBucket bytes;
+	};
+
+	struct Connection {
+		Buckets buckets;
+		//Delayed until (in milliseconds), zero (0) if not delayed
+		unsigned long long deadline;
+	};
+
+	struct Expiry {
+		RateLimiter *limiter;
+		unsigned long long now;
+	};
+
+	struct Resumption {
+		RateLimiter *limiter;
+		unsigned long long now;
+		unsigned long long next;
+		void (*fn)(Socket *connection, void *arg);
+		void *arg;
+	};
+
+	struct HFN {
+		unsigned int operator()(const Socket *s) const noexcept {
+			return Twiddler::mix((unsigned long long) s);
+		}
+	};
+
+	struct EQFN {
+		bool operator()(const Socket *s1, const Socket *s2) const noexcept {
+			return (s1 == s2);
+		}
+	};
+	//Returns true if the <connection> is not subject to the limits
+	static bool isExempt(const Socket *connection) noexcept;
+	//Returns the buckets of the <connection>'s group, nullptr for group 0
+	Buckets* getGroup(const Socket *connection) noexcept;
+	//Initializes the <buckets> with the limits of the <scope>
+	void reset(Buckets &buckets, RateScope scope) const noexcept;
+	/*
+	 * Returns the buckets of the registered <uid>, nullptr if not found. If
+	 * <create> is true then the missing buckets are created at time <now>.
+	 */
+	Buckets* getBuckets(unsigned long long uid, bool create,
+			unsigned long long now) noexcept;
+	//Updates the <buckets> and returns the delay (0 if tokens are available)
+	static unsigned int update(Buckets &buckets,
+			unsigned long long now) noexcept;
+	//Charges the <buckets>
+	static void consume(Buckets &buckets, unsigned int bytes) noexcept;
+	//Releases the per-uid state of the identifiers idle at time <now>
+	void expire(unsigned long long now) noexcept;
+	static int resumeCallback(unsigned int index, void *arg) noexcept;
+	static int expireCallback(unsigned int index, void *arg) noexcept;
+public:
+	//Number of groups
+	static constexpr unsigned int GROUPS = 256;
+private:
+	struct {
+		unsigned int messages;
+		unsigned int bytes;
+		unsigned int burst;
+	} limits[3];
+
+	Khash<const Socket*, Connection, true, HFN, EQFN> connections;
+	Buckets groups[GROUPS];
+	Khash<unsigned long long, Buckets> uids;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_RATELIMITER_H_ */
@@ -0,0 +1,37 @@
+/*
+ * Scheduler.h
+ *
+ * Scheduling policy interface for the incoming messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_SCHEDULER_H_
+#define WH_HUB_SCHEDULER_H_
+
+namespace wanhive {
+class Message;
+class Socket;
+/**
+ * Decides how many of a connection's messages are admitted during its turn.
+ * The hub visits the ready connections in round-robin order and calls
+ * <start>, then <charge> for every admitted message, and finally <stop>.
+ */
+class Scheduler {
+public:
+	virtual ~Scheduler() = default;
+	//Starts the <connection>'s turn, returns false to skip the turn
+	virtual bool start(Socket *connection) noexcept = 0;
+	//Accounts for the admitted <message>, returns false to end the turn
+	virtual bool charge(Socket *connection, const Message *message) noexcept = 0;
+	//Ends the turn, <idle> is true if the connection had nothing more to deliver
+	virtual void stop(Socket *connection, bool idle) noexcept = 0;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_SCHEDULER_H_ */
@@ -16,11 +16,13 @@
 #include "../base/SystemException.h"
 #include "../base/ds/Twiddler.h"
 #include "../base/security/CryptoUtils.h"
+#include <new>
 
 namespace wanhive {
 
 MemoryPool Socket::pool;
 SSLContext *Socket::sslCtx = nullptr;
+decltype(Socket::spillOptions) Socket::spillOptions = { nullptr, 0, 0, 0, 0 };
 
 Socket::Socket(int fd) noexcept :
 		Watcher(fd) {
@@ -114,33 +116,30 @@ bool Socket::callback(void *arg) noexcept {
 
 bool Socket::publish(void *arg) noexcept {
 	auto message = static_cast<Message*>(arg);
-	if (message && (!outQueueLimit || out.readSpace() < outQueueLimit)
-			&& out.put(message)) {
-		message->addReferenceCount();
-		setFlags(WATCHER_OUT);
-		return true;
-	} else {
+	if (!message) {
 		return false;
 	}
-}
 
-void Socket::setTopic(unsigned int index) noexcept {
-	if (subscriptions.set(index)) {
-		setFlags(WATCHER_MULTICAST);
+	bool queued;
+	if (message->testFlags(MSG_PRIORITY)) {
+		//Priority messages are not subject to the output queue limit
+		queued = urgent.put(message);
+	} else {
+		//Spilled messages go out first
+		queued = !spilled()
+				&& (!outQueueLimit || out.readSpace() < outQueueLimit)
+				&& enqueue(message);
 	}
-}
 
-void Socket::clearTopic(unsigned int index) noexcept {
-	subscriptions.clear(index);
-	if (!subscriptions.count()) {
-		clearFlags(WATCHER_MULTICAST);
+	if (queued) {
+		message->addReferenceCount();
+		setFlags(WATCHER_OUT);
+		return true;
+	} else {
+		return false;
 	}
 }
 
-bool Socket::testTopic(unsigned int index) const noexcept {
-	return subscriptions.test(index);
-}
-
 Socket* Socket::accept(bool blocking) {
 	auto sfd = -1;
 	try {
@@ -174,6 +173,7 @@ ssize_t Socket::read() {
 }
 
 ssize_t Socket::write() {
+	refillOutgoingQueue();
 	if (!sslCtx || testFlags(SOCKET_LOCAL)) {
 		return socketWrite();
 	} else {
@@ -250,6 +250,102 @@ unsigned int Socket::getOutputQueueLimit() const noexcept {
 	return outQueueLimit;
 }
 
+unsigned int Socket::backlog() noexcept {
+	return out.readSpace() + urgent.readSpace();
+}
+
+bool Socket::spill(const Message *message) noexcept {
+	if (!message || !spillOptions.size || message->testFlags(MSG_PRIORITY)) {
+		//Priority messages would lose their priority
+		return false;
+	} else if (!overflow
+			&& !(overflow = new (std::nothrow) SpillQueue())) {
+		return false;
+	}
+
+	if (!overflow->isOpen()) {
+		auto now = Timer::timeStamp();
+		if (now < spillOptions.retry
+				|| spillOptions.used + spillOptions.size > spillOptions.limit) {
+			return false;
+		}
+
+		try {
+			overflow->open(spillOptions.path, spillOptions.size);
+			spillOptions.used += spillOptions.size;
+		} catch (const BaseException &e) {
+			//Back off instead of retrying for every message
+			spillOptions.retry = now + SPILL_BACKOFF * 1000ULL;
+			return false;
+		}
+	}
+
+	if (overflow->put(message)) {
+		setFlags(WATCHER_OUT);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+unsigned int Socket::spilled() const noexcept {
+	return overflow ? overflow->count() : 0;
+}
+
+bool Socket::isStarved() const noexcept {
+	return spilled() && !testFlags(WATCHER_OUT);
+}
+
+unsigned long long Socket::messagesDropped() const noexcept {
+	return aqm.messagesDropped();
+}
+
+unsigned long long Socket::bytesDropped() const noexcept {
+	return aqm.bytesDropped();
+}
+
+long long Socket::getCredit() const noexcept {
+	return credit;
+}
+
+void Socket::setCredit(long long credit) noexcept {
+	this->credit = credit;
+}
+
+bool Socket::replace(Message *message,
+		bool (*match)(const Message *queued, void *arg), void *arg) noexcept {
+	if (!message || !match || spilled()) {
+		//Older messages might be waiting in the spill file
+		return false;
+	}
+
+	CircularBufferVector<Message*> vector;
+	CircularBufferVector<unsigned long long> timestamps;
+	auto count = out.getReadable(vector);
+	enqueued.getReadable(timestamps);
+	//The messages at the front are being written out
+	auto busy = outgoingMessages.space() - urgentCount;
+	for (auto index = count; index > busy; --index) {
+		auto i = index - 1;
+		auto first = (i < vector.part[0].length);
+		auto j = first ? i : (i - vector.part[0].length);
+		auto &queued =
+				first ? vector.part[0].base[j] : vector.part[1].base[j];
+		if (queued != message && match(queued, arg)) {
+			message->addReferenceCount();
+			Message::recycle(queued);
+			queued = message;
+			//Queueing delay of the new message starts now
+			auto &timestamp =
+					first ? timestamps.part[0].base[j] :
+							timestamps.part[1].base[j];
+			timestamp = CoDel::isEnabled() ? Timer::timeStamp() : 0;
+			return true;
+		}
+	}
+	return false;
+}
+
 bool Socket::isEphemeralId(unsigned long long id) noexcept {
 	return id > MAX_ACTIVE_ID;
 }
@@ -282,6 +378,13 @@ void Socket::setSSLContext(SSLContext *ctx) noexcept {
 	sslCtx = ctx;
 }
 
+void Socket::setSpillOptions(const char *path, unsigned int size,
+		unsigned long long limit) noexcept {
+	spillOptions.path = path;
+	spillOptions.size = size;
+	spillOptions.limit = limit;
+}
+
 void Socket::initPool(unsigned int size) {
 	pool.initialize(sizeof(Socket), size);
 }
@@ -326,7 +429,10 @@ ssize_t Socket::socketWrite() {
 		adjustOutgoingQueue(nSent);
 		return nSent;
 	} else {
-		//Nothing queued up
+		/*
+		 * Nothing queued up. If the spilled messages are waiting for the
+		 * message pool then the hub resumes the write after it frees up.
+		 */
 		clearFlags(WATCHER_OUT);
 		return 0;
 	}
@@ -389,7 +495,10 @@ ssize_t Socket::secureWrite() {
 		adjustOutgoingQueue(nSent);
 		return nSent;
 	} else {
-		//Nothing queued up
+		/*
+		 * Nothing queued up. If the spilled messages are waiting for the
+		 * message pool then the hub resumes the write after it frees up.
+		 */
 		clearFlags(WATCHER_OUT);
 		return 0;
 	}
@@ -484,37 +593,57 @@ ssize_t Socket::sslWrite(const void *buf, size_t count) {
 }
 
 unsigned int Socket::fillOutgoingQueue() noexcept {
-	if (!outgoingMessages.hasSpace()) {
+	if (outgoingMessages.hasSpace()) {
+		return outgoingMessages.space();
+	}
+
+	//Nothing is being written out, the head of the queue can be dropped
+	manageOutgoingQueue();
+	if (!urgent.isEmpty() || !out.isEmpty()) {
+		//Reset for next write cycle
+		outgoingMessages.clear();
+		//How many outgoing messages can be queued up
+		auto space = Twiddler::min(OUT_BATCH_SIZE, outgoingMessages.capacity());
 		CircularBufferVector<Message*> vector;
-		//Number of outgoing messages queued up, vector has two parts
-		auto space = out.getReadable(vector);
-		if (space) {
-			//Reset for next write cycle
-			outgoingMessages.clear();
-			//How many outgoing messages can be queued up
-			space = Twiddler::min(space, outgoingMessages.capacity());
-			//vec points to the storage of the IOVEC buffer
-			auto vec = outgoingMessages.offset();
-			unsigned int iovCount = 0;
-			for (unsigned int i = 0; i < 2; ++i) {
-				for (unsigned int j = 0;
-						((j < vector.part[i].length) && (iovCount < space));
-						++j) {
-					vec[iovCount].iov_base =
-							vector.part[i].base[j]->getStorage();
-					vec[iovCount].iov_len = vector.part[i].base[j]->remaining();
-					iovCount++;
-				}
-			}
-			totalOutgoingMessages += iovCount;
-			outgoingMessages.setIndex(iovCount); //Move the index forward
-			outgoingMessages.rewind();			//Prepare for next read cycle
+		/*
+		 * Strict priority: the priority messages go first, but only up to a
+		 * quota if the regular messages are waiting (prevents starvation).
+		 */
+		unsigned int iovCount = 0;
+		if (urgent.getReadable(vector)) {
+			auto quota = out.isEmpty() ? space : PRIORITY_QUOTA;
+			iovCount = fillOutgoingQueue(vector, iovCount, quota);
+		}
+		urgentCount = iovCount;
+
+		if (iovCount < space && out.getReadable(vector)) {
+			iovCount = fillOutgoingQueue(vector, iovCount, space);
 		}
+
+		totalOutgoingMessages += iovCount;
+		outgoingMessages.setIndex(iovCount); //Move the index forward
+		outgoingMessages.rewind();			//Prepare for next read cycle
 	}
 
 	return outgoingMessages.space();
 }
 
+unsigned int Socket::fillOutgoingQueue(
+		const CircularBufferVector<Message*> &vector, unsigned int index,
+		unsigned int limit) noexcept {
+	//vec points to the storage of the IOVEC buffer
+	auto vec = outgoingMessages.offset();
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (unsigned int j = 0; ((j < vector.part[i].length) && (index < limit));
+				++j) {
+			vec[index].iov_base = vector.part[i].base[j]->getStorage();
+			vec[index].iov_len = vector.part[i].base[j]->remaining();
+			index++;
+		}
+	}
+	return index;
+}
+
 void Socket::adjustOutgoingQueue(size_t count) noexcept {
 	auto vec = outgoingMessages.offset();
 	auto iovCount = outgoingMessages.space();
@@ -534,7 +663,12 @@ void Socket::adjustOutgoingQueue(size_t count) noexcept {
 
 			//We have dispatched this message, recycle it
 			Message *msg = nullptr;
-			out.get(msg);
+			if (urgentCount) {
+				urgent.get(msg);
+				--urgentCount;
+			} else {
+				msg = dequeue();
+			}
 			Message::recycle(msg);
 			++dispatchedMessageCount;
 		}
@@ -543,6 +677,76 @@ void Socket::adjustOutgoingQueue(size_t count) noexcept {
 	}
 }
 
+void Socket::refillOutgoingQueue() noexcept {
+	auto limit = outQueueLimit ? outQueueLimit : (OUT_QUEUE_SIZE - 1);
+	while (spilled() && out.readSpace() < limit) {
+		auto message = Message::create(getUid());
+		if (!message) {
+			break;
+		} else if (overflow->get(message) && enqueue(message)) {
+			message->addReferenceCount();
+			setFlags(WATCHER_OUT);
+		} else {
+			Message::recycle(message);
+			break;
+		}
+	}
+
+	if (!spilled()) {
+		releaseSpill();
+	}
+}
+
+void Socket::manageOutgoingQueue() noexcept {
+	if (!CoDel::isEnabled()) {
+		return;
+	}
+
+	auto now = Timer::timeStamp();
+	CircularBufferVector<Message*> vector;
+	CircularBufferVector<unsigned long long> timestamps;
+	unsigned int count;
+	while ((count = out.getReadable(vector))
+			&& enqueued.getReadable(timestamps)) {
+		auto message = vector.part[0].base[0];
+		auto timestamp = timestamps.part[0].base[0];
+		auto sojourn = (now > timestamp) ? (now - timestamp) : 0;
+		if (!aqm.drop(sojourn, now, count > 1)) {
+			return;
+		}
+
+		dequeue();
+		aqm.count(message->getLength());
+		Message::recycle(message);
+	}
+}
+
+void Socket::releaseSpill() noexcept {
+	if (overflow && overflow->isOpen()) {
+		overflow->close();
+		spillOptions.used -= spillOptions.size;
+	}
+}
+
+bool Socket::enqueue(Message *message) noexcept {
+	auto now = CoDel::isEnabled() ? Timer::timeStamp() : 0;
+	if (out.put(message)) {
+		enqueued.put(now);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+Message* Socket::dequeue() noexcept {
+	Message *message = nullptr;
+	unsigned long long timestamp = 0;
+	if (out.get(message)) {
+		enqueued.get(timestamp);
+	}
+	return message;
+}
+
 void Socket::clear() noexcept {
 	memset(&address, 0, sizeof(address));
 	memset(&secure, 0, sizeof(secure));
@@ -550,7 +754,11 @@ void Socket::clear() noexcept {
 	totalIncomingMessages = 0;
 	totalOutgoingMessages = 0;
 	outQueueLimit = 0;
+	credit = 0;
 	outgoingMessages.rewind();
+	urgentCount = 0;
+	overflow = nullptr;
+	aqm.clear();
 }
 
 void Socket::cleanup() noexcept {
@@ -558,9 +766,17 @@ void Socket::cleanup() noexcept {
 	Message::recycle(incomingMessage);
 
 	Message *message;
-	while ((out.get(message))) {
+	while ((message = dequeue())) {
 		Message::recycle(message);
 	}
+	while ((urgent.get(message))) {
+		Message::recycle(message);
+	}
+	urgentCount = 0;
+
+	releaseSpill();
+	delete overflow;
+	overflow = nullptr;
 }
 
 } /* namespace wanhive */
@@ -12,7 +12,8 @@
 
 #ifndef WH_HUB_SOCKET_H_
 #define WH_HUB_SOCKET_H_
-#include "Topic.h"
+#include "CoDel.h"
+#include "SpillQueue.h"
 #include "../base/Network.h"
 #include "../base/security/SSLContext.h"
 #include "../base/Timer.h"
@@ -75,9 +76,6 @@ public:
 	void stop() noexcept override final;
 	bool callback(void *arg) noexcept override final;
 	bool publish(void *arg) noexcept override final;
-	void setTopic(unsigned int index) noexcept override final;
-	void clearTopic(unsigned int index) noexcept override final;
-	bool testTopic(unsigned int index) const noexcept override final;
 	//=================================================================
 	/*
 	 * Wrapper for Network::accept. Returns the newly created connection on
@@ -115,6 +113,38 @@ public:
 	 */
 	void setOutputQueueLimit(unsigned int limit) noexcept;
 	unsigned int getOutputQueueLimit() const noexcept;
+	//Returns the number of outgoing messages waiting in the queue
+	unsigned int backlog() noexcept;
+	/*
+	 * Overflow: appends a copy of the <message> to this socket's spill file
+	 * after the output queue has been saturated, the caller retains the
+	 * ownership of the <message>. The spilled messages are moved back into
+	 * the output queue as it drains, and the file is released after it has
+	 * been drained. Returns false if spilling is disabled, the spill file is
+	 * full, the total size of the spill files would exceed the limit, or the
+	 * <message> is a priority message (MSG_PRIORITY).
+	 */
+	bool spill(const Message *message) noexcept;
+	//Returns the number of outgoing messages waiting in the spill file
+	unsigned int spilled() const noexcept;
+	//Returns true if the spilled messages are waiting for the message pool
+	bool isStarved() const noexcept;
+	//Returns the number of outgoing messages dropped by the queue management
+	unsigned long long messagesDropped() const noexcept;
+	//Returns the number of outgoing bytes dropped by the queue management
+	unsigned long long bytesDropped() const noexcept;
+	//Scheduling credit of this connection (see Scheduler)
+	long long getCredit() const noexcept;
+	void setCredit(long long credit) noexcept;
+	/*
+	 * Conflation: replaces the most recent queued message, which hasn't been
+	 * picked up for writing yet, and for which <match> returns true with the
+	 * <message>. Returns false if no such message is found, or if the older
+	 * messages have been spilled.
+	 */
+	bool replace(Message *message,
+			bool (*match)(const Message *queued, void *arg),
+			void *arg) noexcept;
 	//Returns true if the <id> not in the range of the active IDs
 	static bool isEphemeralId(unsigned long long id) noexcept;
 	//Returns the underlying SSL/TLS connection (potentially nullptr)
@@ -128,6 +158,13 @@ public:
 	static Socket* createSocketPair(int &sfd, bool blocking = false);
 	//Set the context for SSL connections
 	static void setSSLContext(SSLContext *ctx) noexcept;
+	/*
+	 * Spill file settings: the files are created inside the directory <path>,
+	 * each one of them is <size> bytes long, and all of them together take up
+	 * at most <limit> bytes. Zero (0) <size> disables spilling.
+	 */
+	static void setSpillOptions(const char *path, unsigned int size,
+			unsigned long long limit) noexcept;
 	//=================================================================
 	static void initPool(unsigned int size);
 	static void destroyPool();
@@ -159,8 +196,24 @@ private:
 	//=================================================================
 	//Create IOVECs from outgoing messages and return the count
 	unsigned int fillOutgoingQueue() noexcept;
+	/*
+	 * Create IOVECs from at most <limit> messages of the <vector> starting at
+	 * the IOVEC <index>, returns the new IOVEC count.
+	 */
+	unsigned int fillOutgoingQueue(const CircularBufferVector<Message*> &vector,
+			unsigned int index, unsigned int limit) noexcept;
 	//Adjust the IOVECs for the next write cycle
 	void adjustOutgoingQueue(size_t count) noexcept;
+	//Move the spilled messages back into the output queue
+	void refillOutgoingQueue() noexcept;
+	//Drop the messages at the head of the output queue (see CoDel)
+	void manageOutgoingQueue() noexcept;
+	//Releases the spill file and its share of the spill limit
+	void releaseSpill() noexcept;
+	//Appends the <message> to the output queue along with the time of enqueue
+	bool enqueue(Message *message) noexcept;
+	//Removes the message at the head of the output queue
+	Message* dequeue() noexcept;
 
 	//Clear internal state
 	void clear() noexcept;
@@ -174,14 +227,20 @@ public:
 	static constexpr unsigned int READ_BUFFER_SIZE = (Message::MTU << 3);
 	//Size of scatter-gather OP buffers, must be power of two
 	static constexpr unsigned int OUT_QUEUE_SIZE = 1024;
+	//Size of the priority messages' queue, must be power of two
+	static constexpr unsigned int PRIORITY_QUEUE_SIZE = 256;
+	//Maximum number of messages written out in a single batch
+	static constexpr unsigned int OUT_BATCH_SIZE = 64;
+	//Priority messages allowed in a batch ahead of the regular messages
+	static constexpr unsigned int PRIORITY_QUOTA = 16;
+	//Spill files are not created for this long after a failure (milliseconds)
+	static constexpr unsigned int SPILL_BACKOFF = 1000;
 private:
 	//-----------------------------------------------------------------
 	//When was this connection created
 	Timer timer;
 	//Current socket connection's address
 	SocketAddress address;
-	//Subscriptions
-	Topic subscriptions;
 	//-----------------------------------------------------------------
 	struct {
 		SSL *ssl; //SSL/TLS connection
@@ -196,6 +255,8 @@ private:
 	unsigned long long totalOutgoingMessages;
 	//Maximum number of outgoing messages this object is allowed to hold
 	unsigned int outQueueLimit;
+	//Maintained by the scheduler
+	long long credit;
 	//Serialized I/P
 	Message *incomingMessage;
 	//This buffer stores the incoming raw bytes
@@ -203,11 +264,30 @@ private:
 
 	//This buffer collects all the outgoing messages
 	StaticCircularBuffer<Message*, OUT_QUEUE_SIZE> out;
+	//Time of enqueue of the messages in <out> (a message can be shared)
+	StaticCircularBuffer<unsigned long long, OUT_QUEUE_SIZE> enqueued;
+	//Outgoing priority messages (MSG_PRIORITY), they bypass the regular ones
+	StaticCircularBuffer<Message*, PRIORITY_QUEUE_SIZE> urgent;
+	//Number of priority messages at the front of the current batch
+	unsigned int urgentCount;
 	//Container for scatter-gather O/P
 	StaticBuffer<iovec, OUT_QUEUE_SIZE> outgoingMessages;
+	//Overflow of the output queue (created on demand)
+	SpillQueue *overflow;
+	//Active queue management of the output queue
+	CoDel aqm;
 	//-----------------------------------------------------------------
 	static MemoryPool pool;
 	static SSLContext *sslCtx; //SSL/TLS context
+	static struct {
+		const char *path;
+		unsigned int size;
+		unsigned long long limit;
+		//Total size of the open spill files
+		unsigned long long used;
+		//No new spill file before this time in microseconds (after a failure)
+		unsigned long long retry;
+	} spillOptions;
 };
 
 } /* namespace wanhive */
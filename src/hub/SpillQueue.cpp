@@ -0,0 +1,142 @@
+/*
+ * SpillQueue.cpp
+ *
+ * File backed overflow queue of messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "SpillQueue.h"
+#include "../base/Storage.h"
+#include "../base/SystemException.h"
+#include "../base/common/Exception.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace wanhive {
+
+SpillQueue::SpillQueue() noexcept :
+		base(nullptr), capacity(0), head(0), tail(0), records(0) {
+
+}
+
+SpillQueue::~SpillQueue() {
+	close();
+}
+
+void SpillQueue::open(const char *path, unsigned int capacity) {
+	if (isOpen()) {
+		throw Exception(EX_INVALIDSTATE);
+	} else if (!path || !path[0] || capacity < (PREFIX_SIZE + Message::MTU)) {
+		throw Exception(EX_INVALIDPARAM);
+	}
+
+	char name[PATH_MAX];
+	auto n = snprintf(name, sizeof(name), "%s%swh-spill-XXXXXX", path,
+			Storage::DIR_SEPARATOR_STR);
+	if (n <= 0 || (size_t) n >= sizeof(name)) {
+		throw Exception(EX_OVERFLOW);
+	}
+
+	auto fd = mkstemp(name);
+	if (fd == -1) {
+		throw SystemException();
+	}
+	//The file is needed only as long as the mapping exists
+	unlink(name);
+
+	auto status = posix_fallocate(fd, 0, capacity);
+	if (status) {
+		Storage::close(fd);
+		throw SystemException(status);
+	}
+
+	auto p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+			0);
+	Storage::close(fd);
+	if (p == MAP_FAILED) {
+		throw SystemException();
+	}
+
+	this->base = (unsigned char*) p;
+	this->capacity = capacity;
+	head = 0;
+	tail = 0;
+	records = 0;
+}
+
+void SpillQueue::close() noexcept {
+	if (base) {
+		munmap(base, capacity);
+	}
+	base = nullptr;
+	capacity = 0;
+	head = 0;
+	tail = 0;
+	records = 0;
+}
+
+bool SpillQueue::isOpen() const noexcept {
+	return base != nullptr;
+}
+
+bool SpillQueue::put(const Message *message) noexcept {
+	if (!base || !message) {
+		return false;
+	}
+
+	uint16_t length = message->getLength();
+	if ((capacity - tail) < (PREFIX_SIZE + length)) {
+		return false;
+	}
+
+	memcpy(base + tail, &length, PREFIX_SIZE);
+	memcpy(base + tail + PREFIX_SIZE, message->getStorage(), length);
+	tail += (PREFIX_SIZE + length);
+	++records;
+	return true;
+}
+
+bool SpillQueue::get(Message *message) noexcept {
+	if (!message) {
+		return false;
+	}
+
+	while (!isEmpty()) {
+		uint16_t length;
+		memcpy(&length, base + head, PREFIX_SIZE);
+		//A corrupt record is discarded, else it would block the queue
+		auto loaded = message->pack(base + head + PREFIX_SIZE);
+		head += (PREFIX_SIZE + length);
+		if (!(--records)) {
+			//Drained, start over
+			head = 0;
+			tail = 0;
+			madvise(base, capacity, MADV_DONTNEED);
+		}
+
+		if (loaded) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SpillQueue::isEmpty() const noexcept {
+	return records == 0;
+}
+
+unsigned int SpillQueue::count() const noexcept {
+	return records;
+}
+
+} /* namespace wanhive */
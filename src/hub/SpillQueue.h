@@ -0,0 +1,61 @@
+/*
+ * SpillQueue.h
+ *
+ * File backed overflow queue of messages
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_SPILLQUEUE_H_
+#define WH_HUB_SPILLQUEUE_H_
+#include "../util/Message.h"
+
+namespace wanhive {
+/**
+ * FIFO queue of serialized messages stored in a memory mapped, append-only
+ * file of fixed capacity. The backing file is created inside the given
+ * directory and unlinked immediately, hence it disappears with the process.
+ * Space is reclaimed after the queue has been drained completely.
+ * Not thread safe
+ */
+class SpillQueue {
+public:
+	SpillQueue() noexcept;
+	~SpillQueue();
+	//-----------------------------------------------------------------
+	//Creates a backing file of <capacity> bytes inside the directory <path>
+	void open(const char *path, unsigned int capacity);
+	//Discards the queued messages and releases the backing file
+	void close() noexcept;
+	//Returns true if the backing file is ready
+	bool isOpen() const noexcept;
+	//-----------------------------------------------------------------
+	//Appends a copy of the <message>, returns false if the file is full
+	bool put(const Message *message) noexcept;
+	/*
+	 * Moves the oldest message into <message>, returns false if none queued.
+	 * The records which fail to load are discarded.
+	 */
+	bool get(Message *message) noexcept;
+	//Returns true if no message is queued
+	bool isEmpty() const noexcept;
+	//Returns the number of queued messages
+	unsigned int count() const noexcept;
+private:
+	//Record header: the message length
+	static constexpr unsigned int PREFIX_SIZE = sizeof(uint16_t);
+
+	unsigned char *base; //Mapped region
+	unsigned int capacity; //Size of the mapped region
+	unsigned int head; //Offset of the oldest record
+	unsigned int tail; //Offset of the next append
+	unsigned int records; //Number of queued records
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_SPILLQUEUE_H_ */
@@ -0,0 +1,61 @@
+/*
+ * TokenBucket.cpp
+ *
+ * Token bucket rate limiter
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "TokenBucket.h"
+
+namespace wanhive {
+
+void TokenBucket::set(unsigned int rate, unsigned int burst) noexcept {
+	this->rate = rate;
+	this->burst = burst ? burst : 1;
+	tokens = this->burst;
+	timestamp = 0;
+}
+
+bool TokenBucket::isEnabled() const noexcept {
+	return rate != 0;
+}
+
+void TokenBucket::update(unsigned long long now) noexcept {
+	if (!rate) {
+		return;
+	} else if (timestamp && now > timestamp) {
+		tokens += ((double) rate * (now - timestamp)) / 1000;
+		tokens = (tokens < burst) ? tokens : burst;
+	}
+	timestamp = now;
+}
+
+bool TokenBucket::isAvailable() const noexcept {
+	return !rate || tokens >= 1;
+}
+
+void TokenBucket::consume(unsigned int count) noexcept {
+	if (rate) {
+		tokens -= count;
+	}
+}
+
+unsigned int TokenBucket::delay() const noexcept {
+	if (isAvailable()) {
+		return 0;
+	} else {
+		//Round up, at least one millisecond
+		return (unsigned int) (((1 - tokens) * 1000) / rate) + 1;
+	}
+}
+
+bool TokenBucket::isFull() const noexcept {
+	return !rate || tokens >= burst;
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,52 @@
+/*
+ * TokenBucket.h
+ *
+ * Token bucket rate limiter
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_TOKENBUCKET_H_
+#define WH_HUB_TOKENBUCKET_H_
+
+namespace wanhive {
+/**
+ * Token bucket: refills at a constant rate up to the burst size. The balance
+ * may go negative (a debt which must be repaid before the next admission),
+ * that allows charging a request after its cost becomes known.
+ * POD type, call set() before use.
+ * Thread safe at class level
+ */
+class TokenBucket {
+public:
+	/*
+	 * Sets the <rate> in tokens per second and the <burst> size (at least one
+	 * token), the bucket starts full. Zero (0) <rate> disables the bucket.
+	 */
+	void set(unsigned int rate, unsigned int burst) noexcept;
+	//Returns true if the bucket is in use
+	bool isEnabled() const noexcept;
+	//Adds the tokens accumulated until <now> (in milliseconds)
+	void update(unsigned long long now) noexcept;
+	//Returns true if at least one token is available
+	bool isAvailable() const noexcept;
+	//Removes <count> tokens, possibly leaving a debt
+	void consume(unsigned int count) noexcept;
+	//Returns the number of milliseconds until a token becomes available
+	unsigned int delay() const noexcept;
+	//Returns true if the bucket is full (nothing to remember)
+	bool isFull() const noexcept;
+private:
+	double tokens;
+	unsigned long long timestamp;
+	unsigned int rate;
+	unsigned int burst;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_TOKENBUCKET_H_ */
@@ -38,6 +38,8 @@ public:
 	static constexpr unsigned int MIN_ID = 0;
 	//Maximum topic identifier
 	static constexpr unsigned int MAX_ID = 255;
+	//Maximum extended topic identifier (carried in the payload)
+	static constexpr unsigned int MAX_XID = 0xffffffff;
 private:
 	unsigned int n;
 	unsigned char map[(COUNT + 7) / 8];
@@ -0,0 +1,140 @@
+/*
+ * TopicFilter.cpp
+ *
+ * Content filter for the topic subscriptions
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "TopicFilter.h"
+#include "../base/ds/Serializer.h"
+#include <cstring>
+
+namespace {
+
+uint64_t readInteger(const unsigned char *buffer, unsigned int width) noexcept {
+	uint64_t n = 0;
+	for (unsigned int i = 0; i < width; ++i) {
+		n = (n << 8) | buffer[i];
+	}
+	return n;
+}
+
+}  // namespace
+
+namespace wanhive {
+
+void TopicFilter::clear() noexcept {
+	op = NONE;
+	width = 0;
+	offset = 0;
+	memset(value, 0, sizeof(value));
+}
+
+bool TopicFilter::setMatch(unsigned int offset, const unsigned char *value,
+		unsigned int length) noexcept {
+	if (!value || !length || length > MAX_VALUE || offset > 0xffff) {
+		return false;
+	} else {
+		clear();
+		this->op = MATCH;
+		this->width = length;
+		this->offset = offset;
+		memcpy(this->value, value, length);
+		return true;
+	}
+}
+
+bool TopicFilter::setCompare(Operator op, unsigned int offset,
+		unsigned int width, uint64_t value) noexcept {
+	if (op < EQ || op > GE || offset > 0xffff
+			|| !(width == 1 || width == 2 || width == 4 || width == 8)) {
+		return false;
+	} else {
+		clear();
+		this->op = op;
+		this->width = width;
+		this->offset = offset;
+		Serializer::packi64(this->value, value);
+		return true;
+	}
+}
+
+bool TopicFilter::isEmpty() const noexcept {
+	return op == NONE;
+}
+
+bool TopicFilter::test(const unsigned char *payload,
+		unsigned int length) const noexcept {
+	if (op == NONE) {
+		return true;
+	} else if (!payload || ((unsigned int) offset + width) > length) {
+		return false;
+	} else if (op == MATCH) {
+		return memcmp(payload + offset, value, width) == 0;
+	}
+
+	auto n = readInteger(payload + offset, width);
+	auto v = Serializer::unpacku64(value);
+	switch (op) {
+	case EQ:
+		return n == v;
+	case NE:
+		return n != v;
+	case LT:
+		return n < v;
+	case LE:
+		return n <= v;
+	case GT:
+		return n > v;
+	case GE:
+		return n >= v;
+	default:
+		return false;
+	}
+}
+
+unsigned int TopicFilter::pack(unsigned char *buffer) const noexcept {
+	buffer[0] = op;
+	buffer[1] = width;
+	Serializer::packi16(buffer + 2, offset);
+	memcpy(buffer + 4, value, MAX_VALUE);
+	return SIZE;
+}
+
+bool TopicFilter::unpack(const unsigned char *buffer) noexcept {
+	op = buffer[0];
+	width = buffer[1];
+	offset = Serializer::unpacku16(buffer + 2);
+	memcpy(value, buffer + 4, MAX_VALUE);
+	if (isValid()) {
+		return true;
+	} else {
+		clear();
+		return false;
+	}
+}
+
+bool TopicFilter::isValid() const noexcept {
+	switch (op) {
+	case NONE:
+		return true;
+	case MATCH:
+		return width && width <= MAX_VALUE;
+	case EQ:
+	case NE:
+	case LT:
+	case LE:
+	case GT:
+	case GE:
+		return width == 1 || width == 2 || width == 4 || width == 8;
+	default:
+		return false;
+	}
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,74 @@
+/*
+ * TopicFilter.h
+ *
+ * Content filter for the topic subscriptions
+ *
+ *
+ * Copyright (C) 2020 Amit Kumar (amitkriit@gmail.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_HUB_TOPICFILTER_H_
+#define WH_HUB_TOPICFILTER_H_
+#include <cstdint>
+
+namespace wanhive {
+/**
+ * Compact predicate on the payload of a publication, evaluated by the hub
+ * before delivering the publication to a subscriber. Either matches a byte
+ * range or compares an unsigned big-endian integer at a fixed payload offset.
+ * A publication too short to be tested never matches.
+ * POD type, call clear() before use.
+ * Thread safe at class level
+ */
+class TopicFilter {
+public:
+	//Supported predicates
+	enum Operator : uint8_t {
+		NONE = 0, /* Always matches */
+		MATCH = 1, /* Byte range equals the value */
+		EQ = 2,
+		NE = 3,
+		LT = 4,
+		LE = 5,
+		GT = 6,
+		GE = 7
+	};
+
+	//Resets the filter (matches everything)
+	void clear() noexcept;
+	//Matches <length> bytes (at most MAX_VALUE) at the payload <offset>
+	bool setMatch(unsigned int offset, const unsigned char *value,
+			unsigned int length) noexcept;
+	//Compares the <width> (1, 2, 4 or 8) byte integer at <offset> with <value>
+	bool setCompare(Operator op, unsigned int offset, unsigned int width,
+			uint64_t value) noexcept;
+	//Returns true if the filter matches everything
+	bool isEmpty() const noexcept;
+	//Tests the <payload> of the given <length>
+	bool test(const unsigned char *payload, unsigned int length) const noexcept;
+
+	//Serializes the filter into <buffer> (SIZE bytes), returns SIZE
+	unsigned int pack(unsigned char *buffer) const noexcept;
+	//Deserializes the filter from <buffer> (SIZE bytes), returns false if invalid
+	bool unpack(const unsigned char *buffer) noexcept;
+public:
+	//Maximum length of a byte range
+	static constexpr unsigned int MAX_VALUE = 16;
+	//Serialized size (operator, width, offset and value)
+	static constexpr unsigned int SIZE = 4 + MAX_VALUE;
+private:
+	//Returns true if the fields are consistent
+	bool isValid() const noexcept;
+private:
+	uint8_t op;
+	uint8_t width;
+	uint16_t offset;
+	unsigned char value[MAX_VALUE];
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_HUB_TOPICFILTER_H_ */
@@ -26,18 +26,6 @@ Watcher::~Watcher() {
 
 }
 
-void Watcher::setTopic(unsigned int index) noexcept {
-
-}
-
-void Watcher::clearTopic(unsigned int index) noexcept {
-
-}
-
-bool Watcher::testTopic(unsigned int index) const noexcept {
-	return false;
-}
-
 bool Watcher::isReady() const noexcept {
 	return Descriptor::isReady(testFlags(WATCHER_OUT));
 }
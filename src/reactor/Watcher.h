@@ -49,16 +49,6 @@ public:
 	//Publish something to this watcher
 	virtual bool publish(void *arg) noexcept = 0;
 	//-----------------------------------------------------------------
-	/**
-	 * Adapters for multicasting
-	 */
-	//Set subscription to the topic <index>
-	virtual void setTopic(unsigned int index) noexcept;
-	//Clear subscription to the topic <index>
-	virtual void clearTopic(unsigned int index) noexcept;
-	//Test whether the topic <index> is subscribed or not
-	virtual bool testTopic(unsigned int index) const noexcept;
-	//-----------------------------------------------------------------
 	//Return true if the underlying descriptor can do some work
 	bool isReady() const noexcept;
 };
@@ -17,12 +17,20 @@
 #include <new>
 #include <postgresql/libpq-fe.h>
 
+namespace {
+//The authenticator is owned by the worker pool
+constexpr uint32_t AUTH_OFFLOADED = 1;
+
+}  // namespace
+
 namespace wanhive {
 
 AuthenticationHub::AuthenticationHub(unsigned long long uid,
 		const char *path) noexcept :
 		Hub(uid, path), fake(true) {
 	memset(&ctx, 0, sizeof(ctx));
+	ctx.cacheWatch = -1;
+	ctx.banWatch = -1;
 }
 
 AuthenticationHub::~AuthenticationHub() {
@@ -30,13 +38,21 @@ AuthenticationHub::~AuthenticationHub() {
 }
 
 void AuthenticationHub::stop(Watcher *w) noexcept {
+	if (ctx.notifier && w->getUid() == ctx.notifier) {
+		//The workers must not outlive their notifier
+		stopWorkers();
+	}
+
 	Authenticator *authenticator = nullptr;
 	auto index = session.get(w->getUid());
 	if (index != session.end()) {
 		session.getValue(index, authenticator);
 		session.remove(index);
 	}
-	delete authenticator;
+
+	if (!authenticator || !authenticator->testFlags(AUTH_OFFLOADED)) {
+		recycleAuthenticator(authenticator);
+	} //else: recycled on collection
 	Hub::stop(w);
 }
 
@@ -53,10 +69,36 @@ void AuthenticationHub::configure(void *arg) {
 		} else {
 			ctx.saltLength = 0;
 		}
+		ctx.poolSize = conf.getNumber("AUTH", "poolSize", 64);
+		if (ctx.poolSize) {
+			authenticators.initialize(ctx.poolSize);
+		}
+
+		ctx.cacheSize = conf.getNumber("AUTH", "cacheSize");
+		ctx.cacheTTL = conf.getNumber("AUTH", "cacheTTL", 60000);
+		ctx.cacheMonitor = conf.getString("AUTH", "cacheMonitor");
+		cache.initialize(ctx.cacheSize, ctx.cacheTTL);
+		if (ctx.cacheSize && ctx.cacheMonitor) {
+			ctx.cacheWatch = addToInotifier(ctx.cacheMonitor,
+					IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE);
+		}
+
+		ctx.banList = conf.getString("AUTH", "banList");
+		if (ctx.banList) {
+			loadBanList();
+		}
+
+		ctx.workers = conf.getNumber("AUTH", "workers");
+		ctx.backlog = conf.getNumber("AUTH", "backlog", 1024);
+		if (ctx.workers && ctx.backlog) {
+			startWorkers();
+		}
 
 		WH_LOG_DEBUG(
-				"Authentication hub settings:\nCONNINFO= \"%s\"\nQUERY= \"%s\"\nSALT= \"%s\"\n",
-				ctx.connInfo, ctx.query, ctx.salt);
+				"Authentication hub settings:\nCONNINFO= \"%s\"\nQUERY= \"%s\"\nSALT= \"%s\"\nPOOL_SIZE= %u\nCACHE_SIZE= %u, CACHE_TTL= %ums, CACHE_MONITOR= \"%s\"\nBAN_LIST= \"%s\"\nWORKERS= %u, BACKLOG= %u\n",
+				ctx.connInfo, ctx.query, ctx.salt, ctx.poolSize, ctx.cacheSize,
+				ctx.cacheTTL, ctx.cacheMonitor, ctx.banList, ctx.workers,
+				ctx.backlog);
 	} catch (const BaseException &e) {
 		WH_LOG_EXCEPTION(e);
 		throw;
@@ -64,8 +106,17 @@ void AuthenticationHub::configure(void *arg) {
 }
 
 void AuthenticationHub::cleanup() noexcept {
+	stopWorkers();
 	session.iterate(_deleteAuthenticators, this);
+	Authenticator *authenticator = nullptr;
+	while (authenticators.get(authenticator)) {
+		delete authenticator;
+	}
+	cache.initialize(0, 0);
+	banned.clear();
 	memset(&ctx, 0, sizeof(ctx));
+	ctx.cacheWatch = -1;
+	ctx.banWatch = -1;
 	//Clean up the base class object
 	Hub::cleanup();
 }
@@ -89,6 +140,49 @@ void AuthenticationHub::route(Message *message) noexcept {
 	}
 }
 
+void AuthenticationHub::processEventNotification(unsigned long long uid,
+		unsigned long long events) noexcept {
+	if (ctx.notifier && uid == ctx.notifier) {
+		collectIdentifications();
+	}
+}
+
+void AuthenticationHub::processInotification(unsigned long long uid,
+		const InotifyEvent *event) noexcept {
+	if (event->wd == -1) { //overflow notification
+		cache.clear();
+		watchCacheMonitor();
+		if (ctx.banList) {
+			loadBanList();
+		}
+	} else if (event->wd == ctx.cacheWatch) {
+		if (event->mask & IN_IGNORED) {
+			//The file was replaced or removed
+			ctx.cacheWatch = -1;
+			watchCacheMonitor();
+		}
+		cache.clear();
+	} else if (event->wd == ctx.banWatch) {
+		if (event->mask & IN_IGNORED) {
+			//The file was replaced or removed
+			ctx.banWatch = -1;
+			loadBanList();
+		} else if (event->mask & (IN_CLOSE_WRITE | IN_ATTRIB)) {
+			//Reload after the write-close
+			loadBanList();
+		}
+	}
+}
+
+void AuthenticationHub::processSignalNotification(unsigned long long uid,
+		const SignalInfo *info) noexcept {
+	if (info->ssi_signo == SIGHUP) {
+		WH_LOG_DEBUG("Identity cache flushed (%u records)", cache.count());
+		cache.clear();
+		watchCacheMonitor();
+	}
+}
+
 int AuthenticationHub::handleIdentificationRequest(Message *message) noexcept {
 	/*
 	 * HEADER: SRC=<identity>, DEST=X, ....CMD=0, QLF=1, AQLF=0/1/127
@@ -105,11 +199,24 @@ int AuthenticationHub::handleIdentificationRequest(Message *message) noexcept {
 	auto nonce = message->getBytes(0);
 	auto identity = message->getSource();
 	Authenticator *authenticator = nullptr;
-	bool success = !isBanned(identity) && (authenticator =
-			new (std::nothrow) Authenticator(true))
+	bool success = !isBanned(identity)
+			&& (authenticator = createAuthenticator())
 			&& loadIdentity(authenticator, identity, nonce, nonceLength)
 			&& session.hmPut(source, authenticator);
 	//-----------------------------------------------------------------
+	if (success && offload(message, authenticator)) {
+		//The response goes out after completion
+		message->setDestination(getUid());
+		message->addReferenceCount(); //Account for Hub::publish
+		return 0;
+	} else {
+		return completeIdentification(message, authenticator,
+				success && authenticator->resume());
+	}
+}
+
+int AuthenticationHub::completeIdentification(Message *message,
+		Authenticator *authenticator, bool success) noexcept {
 	if (success) {
 		unsigned int saltLength = 0;
 		unsigned int hostNonceLength = 0;
@@ -122,8 +229,8 @@ int AuthenticationHub::handleIdentificationRequest(Message *message) noexcept {
 				hostNonceLength, salt, hostNonce);
 	} else {
 		//Free up the memory and stop the <source> from making further requests
-		delete authenticator;
-		session.hmPut(source, nullptr);
+		recycleAuthenticator(authenticator);
+		session.hmReplace(message->getOrigin(), nullptr, authenticator);
 
 		if (ctx.salt && ctx.saltLength) {
 			/*
@@ -136,7 +243,7 @@ int AuthenticationHub::handleIdentificationRequest(Message *message) noexcept {
 			const unsigned char *salt = ctx.salt;
 			const unsigned char *hostNonce = nullptr;
 
-			fake.generateFakeSalt(identity, salt, saltLength);
+			fake.generateFakeSalt(message->getSource(), salt, saltLength);
 			fake.generateFakeNonce(hostNonce, hostNonceLength);
 			saltLength = Twiddler::min(saltLength, 16);
 			return generateIdentificationResponse(message, saltLength,
@@ -158,6 +265,9 @@ int AuthenticationHub::handleAuthenticationRequest(Message *message) noexcept {
 	//-----------------------------------------------------------------
 	if (!session.hmGet(source, authenticator) || !authenticator) {
 		return handleInvalidRequest(message);
+	} else if (authenticator->testFlags(AUTH_OFFLOADED)) {
+		//Identification is in progress
+		return handleInvalidRequest(message);
 	}
 	//-----------------------------------------------------------------
 	auto proofLength = message->getPayloadLength();
@@ -176,7 +286,7 @@ int AuthenticationHub::handleAuthenticationRequest(Message *message) noexcept {
 		return 0;
 	} else {
 		//Free up the memory and stop the <source> from making further requests
-		delete authenticator;
+		recycleAuthenticator(authenticator);
 		session.hmReplace(source, nullptr, authenticator);
 		return handleInvalidRequest(message);
 	}
@@ -214,8 +324,18 @@ int AuthenticationHub::handleInvalidRequest(Message *message) noexcept {
 bool AuthenticationHub::loadIdentity(Authenticator *authenticator,
 		unsigned long long identity, const unsigned char *nonce,
 		unsigned int nonceLength) noexcept {
-	if (!authenticator || !nonce || !nonceLength || !ctx.connInfo
-			|| !ctx.query) {
+	if (!authenticator || !nonce || !nonceLength) {
+		return false;
+	}
+	//-----------------------------------------------------------------
+	const char *salt = nullptr;
+	const char *verifier = nullptr;
+	unsigned char group = 0xff;
+	if (cache.get(identity, salt, verifier, group)) {
+		authenticator->setGroup(group);
+		return authenticator->prepare(identity, nonce, nonceLength, salt,
+				verifier);
+	} else if (!ctx.connInfo || !ctx.query) {
 		return false;
 	}
 	//-----------------------------------------------------------------
@@ -242,19 +362,135 @@ bool AuthenticationHub::loadIdentity(Authenticator *authenticator,
 		return false;
 	}
 	//-----------------------------------------------------------------
-	auto group = PQgetvalue(res, 0, 3);
-	authenticator->setGroup(
-			group == nullptr ? 0xff : ntohl(*((uint32_t*) group)));
-	auto status = authenticator->identify(identity, nonce, nonceLength,
-			PQgetvalue(res, 0, 1), PQgetvalue(res, 0, 2));
+	auto type = PQgetvalue(res, 0, 3);
+	group = (type == nullptr) ? 0xff : ntohl(*((uint32_t*) type));
+	salt = PQgetvalue(res, 0, 1);
+	verifier = PQgetvalue(res, 0, 2);
+	authenticator->setGroup(group);
+	auto status = authenticator->prepare(identity, nonce, nonceLength, salt,
+			verifier);
+	if (status) {
+		cache.put(identity, salt, verifier, group);
+	}
 	//-----------------------------------------------------------------
 	PQclear(res);
 	PQfinish(conn);
 	return status;
 }
 
+bool AuthenticationHub::offload(Message *message,
+		Authenticator *authenticator) noexcept {
+	if (!ctx.notifier) {
+		return false;
+	}
+
+	SrpWorkers::Job job { message->getOrigin(), authenticator, message, false };
+	authenticator->setFlags(AUTH_OFFLOADED);
+	if (workers.submit(job)) {
+		//Held until the collection
+		message->addReferenceCount();
+		return true;
+	} else {
+		authenticator->clearFlags(AUTH_OFFLOADED);
+		return false;
+	}
+}
+
+void AuthenticationHub::collectIdentifications() noexcept {
+	SrpWorkers::Job job;
+	while (workers.collect(job)) {
+		auto authenticator = job.authenticator;
+		authenticator->clearFlags(AUTH_OFFLOADED);
+
+		Authenticator *current = nullptr;
+		Watcher *w = nullptr;
+		if (!session.hmGet(job.source, current) || current != authenticator
+				|| !(w = getWatcher(job.source))) {
+			//The connection has been closed in the meantime
+			recycleAuthenticator(authenticator);
+		} else {
+			completeIdentification(job.message, authenticator, job.success);
+			if (w->publish(job.message) && w->isReady()) {
+				retain(w);
+			}
+		}
+		Message::recycle(job.message);
+	}
+}
+
+void AuthenticationHub::startWorkers() {
+	EventNotifier *notifier = nullptr;
+	try {
+		notifier = new EventNotifier(false);
+		putWatcher(notifier, IO_READ, WATCHER_ACTIVE);
+	} catch (const BaseException &e) {
+		delete notifier;
+		throw;
+	} catch (...) {
+		delete notifier;
+		throw Exception(EX_ALLOCFAILED);
+	}
+
+	//The notifier is owned by the hub now
+	workers.start(ctx.workers, ctx.backlog, notifier);
+	ctx.notifier = notifier->getUid();
+}
+
+void AuthenticationHub::stopWorkers() noexcept {
+	workers.stop();
+	collectIdentifications();
+	ctx.notifier = 0;
+}
+
 bool AuthenticationHub::isBanned(unsigned long long identity) const noexcept {
-	return false;
+	return banned.contains(identity);
+}
+
+void AuthenticationHub::watchCacheMonitor() noexcept {
+	try {
+		if (ctx.cacheSize && ctx.cacheMonitor && ctx.cacheWatch == -1) {
+			ctx.cacheWatch = addToInotifier(ctx.cacheMonitor,
+					IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE);
+		}
+	} catch (const BaseException &e) {
+		//Retried on the next flush
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+void AuthenticationHub::loadBanList() noexcept {
+	try {
+		if (ctx.banWatch == -1) {
+			ctx.banWatch = addToInotifier(ctx.banList,
+					IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE);
+		}
+		banned.load(ctx.banList);
+		WH_LOG_DEBUG("Ban list loaded (%u identities)", banned.count());
+	} catch (const BaseException &e) {
+		//Keep the existing list
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+Authenticator* AuthenticationHub::createAuthenticator() noexcept {
+	Authenticator *authenticator = nullptr;
+	if (authenticators.get(authenticator)) {
+		return authenticator;
+	} else {
+		return new (std::nothrow) Authenticator(true);
+	}
+}
+
+void AuthenticationHub::recycleAuthenticator(
+		Authenticator *authenticator) noexcept {
+	if (!authenticator) {
+		return;
+	}
+
+	authenticator->reset();
+	if (!authenticators.put(authenticator)) {
+		delete authenticator;
+	}
 }
 
 int AuthenticationHub::generateIdentificationResponse(Message *message,
@@ -12,6 +12,9 @@
 
 #ifndef WH_SERVER_AUTH_AUTHENTICATIONHUB_H_
 #define WH_SERVER_AUTH_AUTHENTICATIONHUB_H_
+#include "BanList.h"
+#include "IdentityCache.h"
+#include "SrpWorkers.h"
 #include "../../hub/Hub.h"
 #include "../../util/Authenticator.h"
 
@@ -30,6 +33,12 @@ private:
 	void configure(void *arg) final;
 	void cleanup() noexcept override final;
 	void route(Message *message) noexcept override final;
+	void processEventNotification(unsigned long long uid,
+			unsigned long long events) noexcept override final;
+	void processInotification(unsigned long long uid,
+			const InotifyEvent *event) noexcept override final;
+	void processSignalNotification(unsigned long long uid,
+			const SignalInfo *info) noexcept override final;
 	//-----------------------------------------------------------------
 	//User -> Host:  I, A; Host -> User:  s, B
 	int handleIdentificationRequest(Message *message) noexcept;
@@ -37,13 +46,32 @@ private:
 	int handleAuthenticationRequest(Message *message) noexcept;
 	int handleAuthorizationRequest(Message *message) noexcept;
 	int handleInvalidRequest(Message *message) noexcept;
-	//Load the identity from a database
+	//Prepare the identification using the cache or a database
 	bool loadIdentity(Authenticator *authenticator, unsigned long long identity,
 			const unsigned char *nonce, unsigned int nonceLength) noexcept;
+	//Hands over the prepared identification to the worker pool
+	bool offload(Message *message, Authenticator *authenticator) noexcept;
+	//Responds to the identification requests completed by the worker pool
+	void collectIdentifications() noexcept;
+	//Starts the worker pool
+	void startWorkers();
+	//Stops the worker pool after collecting all the identifications
+	void stopWorkers() noexcept;
 	//Returns true if the given identity is banned
 	bool isBanned(unsigned long long identity) const noexcept;
+	//Watches the <cacheMonitor> for modifications if not watched already
+	void watchCacheMonitor() noexcept;
+	//(Re)loads the ban list and watches the file for modifications
+	void loadBanList() noexcept;
+	//Returns an authenticator from the pool, allocates a new one if empty
+	Authenticator* createAuthenticator() noexcept;
+	//Wipes and returns the <authenticator> to the pool, deletes it if full
+	void recycleAuthenticator(Authenticator *authenticator) noexcept;
 	//-----------------------------------------------------------------
-	//Helper function for <handleIdentificationRequest>
+	//Responds to the identification request after completion
+	int completeIdentification(Message *message, Authenticator *authenticator,
+			bool success) noexcept;
+	//Helper function for <completeIdentification>
 	int generateIdentificationResponse(Message *message,
 			unsigned int saltLength, unsigned int nonceLength,
 			const unsigned char *salt, const unsigned char *nonce) noexcept;
@@ -52,14 +80,42 @@ private:
 private:
 	//Look up table of the authenticators
 	Khash<unsigned long long, Authenticator*> session;
+	//Reusable authenticators
+	CircularBuffer<Authenticator*> authenticators;
 	//For obfuscating failed identification
 	Authenticator fake;
+	//Recently loaded identities
+	IdentityCache cache;
+	//Identities rejected without any database or crypto work
+	BanList banned;
+	//Completes the identifications off the event loop
+	SrpWorkers workers;
 
 	struct {
 		const char *connInfo;
 		const char *query;
 		const unsigned char *salt;
 		unsigned int saltLength;
+		//Number of reusable authenticators
+		unsigned int poolSize;
+		//Number of cached identities (0 to disable)
+		unsigned int cacheSize;
+		//Cached identities expire after this many milliseconds
+		unsigned int cacheTTL;
+		//Modification of this file flushes the cache
+		const char *cacheMonitor;
+		//Watch descriptor of the <cacheMonitor>
+		int cacheWatch;
+		//File containing the banned identities
+		const char *banList;
+		//Watch descriptor of the <banList>
+		int banWatch;
+		//Number of worker threads (0 to identify inline)
+		unsigned int workers;
+		//Maximum number of identifications in progress
+		unsigned int backlog;
+		//Identifier of the worker pool's event notifier
+		unsigned long long notifier;
 	} ctx;
 };
 
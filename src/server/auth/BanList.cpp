@@ -0,0 +1,88 @@
+/*
+ * BanList.cpp
+ *
+ * List of the banned identities
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "BanList.h"
+#include "../../base/Storage.h"
+#include "../../base/common/Exception.h"
+#include <cstdio>
+
+namespace {
+
+//Reads the next identity from the stream, returns false at the end
+bool nextIdentity(FILE *f, unsigned long long &identity) noexcept {
+	char line[256];
+	while (fgets(line, sizeof(line), f)) {
+		//Blank lines and comments are ignored
+		if (sscanf(line, " %llu", &identity) == 1) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}  // namespace
+
+namespace wanhive {
+
+BanList::BanList() noexcept :
+		current(0) {
+
+}
+
+BanList::~BanList() {
+
+}
+
+void BanList::load(const char *path) {
+	auto f = path ? Storage::openStream(path, "r", false) : nullptr;
+	if (!f) {
+		throw Exception(EX_RESOURCE);
+	}
+
+	auto &list = lists[current ^ 1];
+	try {
+		list.clear();
+		unsigned long long identity = 0;
+		while (nextIdentity(f, identity)) {
+			int ret = 0;
+			if (list.put(identity, ret) == list.end()) {
+				throw Exception(EX_ALLOCFAILED);
+			}
+		}
+		Storage::closeStream(f);
+	} catch (const BaseException &e) {
+		Storage::closeStream(f);
+		list.clear();
+		throw;
+	}
+
+	//Release the old list
+	current ^= 1;
+	lists[current ^ 1].clear();
+}
+
+bool BanList::contains(unsigned long long identity) const noexcept {
+	auto &list = lists[current];
+	return list.size() && list.contains(identity);
+}
+
+void BanList::clear() noexcept {
+	for (auto &list : lists) {
+		list.clear();
+	}
+}
+
+unsigned int BanList::count() const noexcept {
+	return lists[current].size();
+}
+
+} /* namespace wanhive */
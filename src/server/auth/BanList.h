@@ -0,0 +1,46 @@
+/*
+ * BanList.h
+ *
+ * List of the banned identities
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_AUTH_BANLIST_H_
+#define WH_SERVER_AUTH_BANLIST_H_
+#include "../../base/ds/Khash.h"
+
+namespace wanhive {
+/**
+ * In-memory list of the banned identities loaded from a text file (one
+ * identity per line), kept in a hash set.
+ * Thread safe at class level
+ */
+class BanList {
+public:
+	BanList() noexcept;
+	~BanList();
+	/*
+	 * Replaces the list with the identities listed in the file at <path>. On
+	 * failure the existing list is retained.
+	 */
+	void load(const char *path);
+	//Returns true if the <identity> is banned
+	bool contains(unsigned long long identity) const noexcept;
+	//Removes all the identities
+	void clear() noexcept;
+	//Returns the number of identities
+	unsigned int count() const noexcept;
+private:
+	//A new list is built in the spare slot and replaces the current one
+	Khash<unsigned long long, unsigned char, false> lists[2];
+	unsigned int current;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_AUTH_BANLIST_H_ */
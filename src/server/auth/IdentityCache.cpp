@@ -0,0 +1,166 @@
+/*
+ * IdentityCache.cpp
+ *
+ * Cache of the identities' authentication records
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "IdentityCache.h"
+#include "../../base/Timer.h"
+#include "../../base/common/Exception.h"
+#include <cstring>
+#include <new>
+#include <openssl/crypto.h>
+
+namespace wanhive {
+
+IdentityCache::IdentityCache() noexcept :
+		records(nullptr), capacity(0), ttl(0), head(NONE), tail(NONE), free(
+				NONE), size(0) {
+
+}
+
+IdentityCache::~IdentityCache() {
+	clear();
+	delete[] records;
+}
+
+void IdentityCache::initialize(unsigned int capacity, unsigned int ttl) {
+	clear();
+	delete[] records;
+	records = nullptr;
+	this->capacity = 0;
+	this->ttl = ttl;
+	free = NONE;
+	if (!capacity) {
+		return;
+	} else if (!(records = new (std::nothrow) Record[capacity])) {
+		throw Exception(EX_ALLOCFAILED);
+	}
+
+	this->capacity = capacity;
+	for (unsigned int i = 0; i < capacity; ++i) {
+		records[i].next = (i + 1 < capacity) ? (i + 1) : NONE;
+	}
+	free = 0;
+}
+
+bool IdentityCache::get(unsigned long long identity, const char *&salt,
+		const char *&verifier, unsigned char &group) noexcept {
+	unsigned int i;
+	if (!index.hmGet(identity, i)) {
+		return false;
+	}
+
+	auto &record = records[i];
+	//Timestamps are in microseconds, the TTL in milliseconds
+	if (ttl && (Timer::timeStamp() - record.timestamp) >= ttl * 1000ULL) {
+		release(i);
+		return false;
+	}
+
+	//Most recently used
+	unlink(i);
+	link(i);
+	salt = record.salt;
+	verifier = record.verifier;
+	group = record.group;
+	return true;
+}
+
+bool IdentityCache::put(unsigned long long identity, const char *salt,
+		const char *verifier, unsigned char group) noexcept {
+	if (!capacity || !salt || !verifier || strlen(salt) > SALT_LENGTH
+			|| strlen(verifier) > VERIFIER_LENGTH) {
+		return false;
+	}
+
+	unsigned int i;
+	if (index.hmGet(identity, i)) {
+		unlink(i);
+	} else {
+		if (free == NONE) {
+			//Evict the least recently used record
+			release(tail);
+		}
+
+		i = free;
+		if (!index.hmPut(identity, i)) {
+			return false;
+		}
+		free = records[i].next;
+		size += 1;
+	}
+
+	auto &record = records[i];
+	record.identity = identity;
+	record.timestamp = Timer::timeStamp();
+	record.group = group;
+	strcpy(record.salt, salt);
+	strcpy(record.verifier, verifier);
+	link(i);
+	return true;
+}
+
+void IdentityCache::remove(unsigned long long identity) noexcept {
+	unsigned int i;
+	if (index.hmGet(identity, i)) {
+		release(i);
+	}
+}
+
+void IdentityCache::clear() noexcept {
+	while (head != NONE) {
+		release(head);
+	}
+}
+
+unsigned int IdentityCache::count() const noexcept {
+	return size;
+}
+
+void IdentityCache::unlink(unsigned int index) noexcept {
+	auto &record = records[index];
+	if (record.prev != NONE) {
+		records[record.prev].next = record.next;
+	} else {
+		head = record.next;
+	}
+
+	if (record.next != NONE) {
+		records[record.next].prev = record.prev;
+	} else {
+		tail = record.prev;
+	}
+}
+
+void IdentityCache::link(unsigned int index) noexcept {
+	auto &record = records[index];
+	record.prev = NONE;
+	record.next = head;
+	if (head != NONE) {
+		records[head].prev = index;
+	} else {
+		tail = index;
+	}
+	head = index;
+}
+
+void IdentityCache::release(unsigned int index) noexcept {
+	auto &record = records[index];
+	unlink(index);
+	this->index.removeKey(record.identity);
+	//The verifier is sensitive
+	OPENSSL_cleanse(record.salt, sizeof(record.salt));
+	OPENSSL_cleanse(record.verifier, sizeof(record.verifier));
+	record.next = free;
+	free = index;
+	size -= 1;
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,87 @@
+/*
+ * IdentityCache.h
+ *
+ * Cache of the identities' authentication records
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_AUTH_IDENTITYCACHE_H_
+#define WH_SERVER_AUTH_IDENTITYCACHE_H_
+#include "../../base/ds/Khash.h"
+
+namespace wanhive {
+/**
+ * Bounded LRU cache of the (salt, verifier, group) records of the identities.
+ * The records expire after the TTL, the least recently used record is evicted
+ * if the cache is full.
+ * Thread safe at class level
+ */
+class IdentityCache {
+public:
+	IdentityCache() noexcept;
+	~IdentityCache();
+	/*
+	 * Keeps up to <capacity> records (0 disables the cache), each one of
+	 * them for at most <ttl> milliseconds (0 for no expiry). Clears the cache.
+	 */
+	void initialize(unsigned int capacity, unsigned int ttl);
+	/*
+	 * Looks up the record of the <identity>. On success the hexadecimal
+	 * <salt> and <verifier> remain valid until the next modification.
+	 */
+	bool get(unsigned long long identity, const char *&salt,
+			const char *&verifier, unsigned char &group) noexcept;
+	//Inserts or replaces the record of the <identity>
+	bool put(unsigned long long identity, const char *salt,
+			const char *verifier, unsigned char group) noexcept;
+	//Removes the record of the <identity>
+	void remove(unsigned long long identity) noexcept;
+	//Removes all the records
+	void clear() noexcept;
+	//Returns the number of records
+	unsigned int count() const noexcept;
+private:
+	//Unlinks the record at <index> from the recency list
+	void unlink(unsigned int index) noexcept;
+	//Links the record at <index> at the front of the recency list
+	void link(unsigned int index) noexcept;
+	//Removes the record at <index>
+	void release(unsigned int index) noexcept;
+public:
+	//Maximum length of the hexadecimal salt
+	static constexpr unsigned int SALT_LENGTH = 128;
+	//Maximum length of the hexadecimal verifier (8192-bit group)
+	static constexpr unsigned int VERIFIER_LENGTH = 2048;
+private:
+	//Marks the end of the lists
+	static constexpr unsigned int NONE = 0xffffffff;
+
+	struct Record {
+		unsigned long long identity;
+		unsigned long long timestamp;
+		unsigned int prev;
+		unsigned int next;
+		unsigned char group;
+		char salt[SALT_LENGTH + 1];
+		char verifier[VERIFIER_LENGTH + 1];
+	};
+
+	//Maps the identities to the records
+	Khash<unsigned long long, unsigned int> index;
+	Record *records;
+	unsigned int capacity;
+	unsigned int ttl;
+	unsigned int head; //Most recently used
+	unsigned int tail; //Least recently used
+	unsigned int free; //List of the unused records
+	unsigned int size;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_AUTH_IDENTITYCACHE_H_ */
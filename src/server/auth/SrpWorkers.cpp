@@ -0,0 +1,189 @@
+/*
+ * SrpWorkers.cpp
+ *
+ * Thread pool for the SRP-6a computations
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "SrpWorkers.h"
+#include "../../base/Logger.h"
+#include "../../base/common/Atomic.h"
+#include "../../base/common/Exception.h"
+#include <cstdlib>
+#include <new>
+
+namespace wanhive {
+
+SrpWorkers::SrpWorkers() noexcept :
+		threads(nullptr), nThreads(0), notifier(nullptr), capacity(0), jobs(
+				0), running(0) {
+	mutex = PTHREAD_MUTEX_INITIALIZER;
+}
+
+SrpWorkers::~SrpWorkers() {
+	stop();
+	pthread_mutex_destroy(&mutex);
+}
+
+void SrpWorkers::start(unsigned int threads, unsigned int capacity,
+		EventNotifier *notifier) {
+	if (this->threads) {
+		throw Exception(EX_INVALIDSTATE);
+	} else if (!threads || !capacity || !notifier) {
+		throw Exception(EX_INVALIDPARAM);
+	}
+
+	//Both the queues can hold all the jobs
+	pending.initialize(capacity + 1);
+	finished.initialize(capacity + 1);
+	this->capacity = capacity;
+	this->jobs = 0;
+	this->notifier = notifier;
+
+	this->threads = new (std::nothrow) Thread*[threads];
+	if (!this->threads) {
+		throw Exception(EX_ALLOCFAILED);
+	}
+
+	setStatus(1);
+	for (nThreads = 0; nThreads < threads; ++nThreads) {
+		try {
+			auto th = new Thread(this);
+			this->threads[nThreads] = th;
+			th->start();
+		} catch (const BaseException &e) {
+			//Roll back
+			delete this->threads[nThreads];
+			stop();
+			throw;
+		} catch (...) {
+			stop();
+			throw Exception(EX_ALLOCFAILED);
+		}
+	}
+}
+
+void SrpWorkers::stop() noexcept {
+	if (!threads) {
+		return;
+	}
+
+	setStatus(0);
+	try {
+		wake.notify();
+		for (unsigned int i = 0; i < nThreads; ++i) {
+			threads[i]->join();
+			delete threads[i];
+		}
+	} catch (const BaseException &e) {
+		//The workers may still be running, do not try to recover
+		WH_LOG_EXCEPTION(e);
+		abort();
+	}
+
+	delete[] threads;
+	threads = nullptr;
+	nThreads = 0;
+}
+
+bool SrpWorkers::submit(const Job &job) noexcept {
+	if (!getStatus() || !job.authenticator) {
+		return false;
+	}
+
+	lock();
+	auto success = (jobs < capacity) && pending.put(job);
+	if (success) {
+		++jobs;
+	}
+	unlock();
+
+	if (success) {
+		try {
+			wake.notify();
+		} catch (const BaseException &e) {
+			//The job will be picked up by the next notification
+			WH_LOG_EXCEPTION(e);
+		}
+	}
+	return success;
+}
+
+bool SrpWorkers::collect(Job &job) noexcept {
+	lock();
+	auto success = finished.get(job);
+	if (success) {
+		--jobs;
+	}
+	unlock();
+	return success;
+}
+
+void SrpWorkers::run(void *arg) noexcept {
+	try {
+		Job job;
+		while (true) {
+			if (take(job)) {
+				job.success = job.authenticator->resume();
+				finish(job);
+			} else if (!getStatus()) {
+				//Cascade the shutdown to the next worker
+				wake.notify();
+				break;
+			} else {
+				wake.wait();
+			}
+		}
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+int SrpWorkers::getStatus() const noexcept {
+	return Atomic<int>::load((int*) &running, MO_ACQUIRE);
+}
+
+void SrpWorkers::setStatus(int status) noexcept {
+	Atomic<int>::store(&running, status, MO_RELEASE);
+}
+
+bool SrpWorkers::take(Job &job) noexcept {
+	lock();
+	auto success = pending.get(job);
+	auto more = !pending.isEmpty();
+	unlock();
+
+	if (more) {
+		//A single notification wakes up a single worker
+		wake.notify();
+	}
+	return success;
+}
+
+void SrpWorkers::finish(const Job &job) noexcept {
+	lock();
+	finished.put(job);
+	unlock();
+	try {
+		notifier->write(1);
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+	}
+}
+
+void SrpWorkers::lock() noexcept {
+	if (pthread_mutex_lock(&mutex)) {
+		abort();
+	}
+}
+
+void SrpWorkers::unlock() noexcept {
+	pthread_mutex_unlock(&mutex);
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,85 @@
+/*
+ * SrpWorkers.h
+ *
+ * Thread pool for the SRP-6a computations
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_AUTH_SRPWORKERS_H_
+#define WH_SERVER_AUTH_SRPWORKERS_H_
+#include "../../base/Condition.h"
+#include "../../base/Thread.h"
+#include "../../base/ds/CircularBuffer.h"
+#include "../../hub/EventNotifier.h"
+#include "../../util/Authenticator.h"
+#include "../../util/Message.h"
+
+namespace wanhive {
+/**
+ * Completes the prepared identifications (see Authenticator::resume) in a
+ * pool of threads. The finished jobs are collected by the owner after the
+ * notification through an EventNotifier.
+ * Thread safe
+ */
+class SrpWorkers: private Task {
+public:
+	struct Job {
+		//Identifier of the requesting connection
+		unsigned long long source;
+		//Prepared authenticator, owned by the pool until collected
+		Authenticator *authenticator;
+		//The request waiting for the response, never accessed by the pool
+		Message *message;
+		//Result of the identification
+		bool success;
+	};
+
+	SrpWorkers() noexcept;
+	~SrpWorkers();
+	//-----------------------------------------------------------------
+	/*
+	 * Starts <threads> workers which accept at most <capacity> uncollected
+	 * jobs. Each finished job is reported to the <notifier>.
+	 */
+	void start(unsigned int threads, unsigned int capacity,
+			EventNotifier *notifier);
+	//Waits for the workers to finish the queued jobs and exit
+	void stop() noexcept;
+	//-----------------------------------------------------------------
+	//Queues the <job>, returns false if the pool is full or stopped
+	bool submit(const Job &job) noexcept;
+	//Removes a finished job, returns false if there is none
+	bool collect(Job &job) noexcept;
+private:
+	void run(void *arg) noexcept override final;
+	int getStatus() const noexcept override final;
+	void setStatus(int status) noexcept override final;
+	//Removes a queued job, returns false if there is none
+	bool take(Job &job) noexcept;
+	//Moves the <job> to the finished queue
+	void finish(const Job &job) noexcept;
+	void lock() noexcept;
+	void unlock() noexcept;
+private:
+	Thread **threads;
+	unsigned int nThreads;
+	EventNotifier *notifier;
+	//Wakes up the idle workers
+	Condition wake;
+	//Protects the queues and the counter
+	pthread_mutex_t mutex;
+	CircularBuffer<Job> pending;
+	CircularBuffer<Job> finished;
+	unsigned int capacity;
+	unsigned int jobs;
+	int running;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_AUTH_SRPWORKERS_H_ */
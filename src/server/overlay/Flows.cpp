@@ -0,0 +1,80 @@
+/*
+ * Flows.cpp
+ *
+ * Pinning of the client flows to the parallel links
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Flows.h"
+
+namespace wanhive {
+
+Flows::Flows() noexcept :
+		limit(0) {
+
+}
+
+Flows::~Flows() {
+
+}
+
+void Flows::setLimit(unsigned int limit) noexcept {
+	this->limit = limit;
+}
+
+unsigned int Flows::getLimit() const noexcept {
+	return limit;
+}
+
+bool Flows::get(unsigned long long flow, unsigned long long &link) noexcept {
+	auto i = flows.get(flow);
+	if (i == flows.end()) {
+		return false;
+	}
+
+	auto f = flows.getValueReference(i);
+	f->active = true;
+	link = f->link;
+	return true;
+}
+
+bool Flows::put(unsigned long long flow, unsigned long long link) noexcept {
+	int ret = 0;
+	unsigned int i;
+	if (!flows.contains(flow) && flows.size() >= limit) {
+		return false;
+	} else if ((i = flows.put(flow, ret)) == flows.end()) {
+		return false;
+	} else {
+		return flows.setValue(i, { link, true });
+	}
+}
+
+void Flows::expire() noexcept {
+	flows.iterate(expireCallback, this);
+}
+
+unsigned int Flows::count() const noexcept {
+	return flows.size();
+}
+
+void Flows::clear() noexcept {
+	flows.clear();
+}
+
+int Flows::expireCallback(unsigned int index, void *arg) noexcept {
+	auto f = static_cast<Flows*>(arg)->flows.getValueReference(index);
+	if (!f->active) {
+		return 1;
+	} else {
+		f->active = false;
+		return 0;
+	}
+}
+
+} /* namespace wanhive */
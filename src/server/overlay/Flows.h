@@ -0,0 +1,59 @@
+/*
+ * Flows.h
+ *
+ * Pinning of the client flows to the parallel links
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_OVERLAY_FLOWS_H_
+#define WH_SERVER_OVERLAY_FLOWS_H_
+#include "../../base/ds/Khash.h"
+
+namespace wanhive {
+/**
+ * Remembers the link each flow has been assigned to, so that a flow stays on
+ * the same link (and in order) for as long as the link exists. A flow is
+ * identified by a 64-bit key, usually the hash of its source and destination.
+ * The flows which stay idle for an expiry period are forgotten.
+ * Thread safe at class level
+ */
+class Flows {
+public:
+	Flows() noexcept;
+	~Flows();
+	//-----------------------------------------------------------------
+	//At most <limit> flows are pinned, zero (0) disables the pinning
+	void setLimit(unsigned int limit) noexcept;
+	//Returns the maximum number of pinned flows
+	unsigned int getLimit() const noexcept;
+	//-----------------------------------------------------------------
+	//Returns the <link> of the <flow> and marks it active, false if not pinned
+	bool get(unsigned long long flow, unsigned long long &link) noexcept;
+	//Pins the <flow> to the <link>, returns false if the table is full
+	bool put(unsigned long long flow, unsigned long long link) noexcept;
+	//Forgets the flows which have been idle since the last call
+	void expire() noexcept;
+	//Returns the number of pinned flows
+	unsigned int count() const noexcept;
+	//Forgets all the flows
+	void clear() noexcept;
+private:
+	static int expireCallback(unsigned int index, void *arg) noexcept;
+private:
+	struct Flow {
+		unsigned long long link;
+		bool active;
+	};
+
+	Khash<unsigned long long, Flow> flows;
+	unsigned int limit;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_OVERLAY_FLOWS_H_ */
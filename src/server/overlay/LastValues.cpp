@@ -0,0 +1,135 @@
+/*
+ * LastValues.cpp
+ *
+ * Per-topic last-value cache
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "LastValues.h"
+#include "../../base/ds/Twiddler.h"
+#include <new>
+
+namespace wanhive {
+
+LastValues::LastValues() noexcept :
+		depth(0), limit(0), total(0) {
+
+}
+
+LastValues::~LastValues() {
+	clear();
+}
+
+void LastValues::setDepth(unsigned int depth) noexcept {
+	depth = Twiddler::min(depth, MAX_DEPTH);
+	if (depth != this->depth) {
+		//The rings are sized for the old depth
+		clear();
+		this->depth = depth;
+	}
+}
+
+unsigned int LastValues::getDepth() const noexcept {
+	return depth;
+}
+
+void LastValues::setLimit(unsigned int limit) noexcept {
+	if (limit < total) {
+		clear();
+	}
+	this->limit = limit;
+}
+
+unsigned int LastValues::getLimit() const noexcept {
+	return limit;
+}
+
+bool LastValues::put(unsigned int topic, Message *msg,
+		unsigned char group) noexcept {
+	if (!depth || !msg) {
+		return false;
+	}
+
+	auto i = rings.get(topic);
+	if (i == rings.end()) {
+		if (total >= limit) {
+			return false;
+		}
+
+		int ret = 0;
+		Ring ring { new (std::nothrow) Slot[depth], 0, 0 };
+		if (!ring.slots) {
+			return false;
+		} else if ((i = rings.put(topic, ret)) == rings.end()
+				|| !rings.setValue(i, ring)) {
+			delete[] ring.slots;
+			return false;
+		}
+	}
+
+	auto ring = rings.getValueReference(i);
+	if (ring->count == depth || (total >= limit && ring->count)) {
+		//Replace the oldest message
+		Message::recycle(ring->slots[ring->head].msg);
+		ring->head = (ring->head + 1) % depth;
+		ring->count -= 1;
+		total -= 1;
+	} else if (total >= limit) {
+		return false;
+	}
+
+	auto &slot = ring->slots[(ring->head + ring->count) % depth];
+	slot.msg = msg;
+	slot.group = group;
+	msg->addReferenceCount();
+	ring->count += 1;
+	total += 1;
+	return true;
+}
+
+Message* LastValues::get(unsigned int topic, unsigned int index,
+		unsigned char &group) const noexcept {
+	Ring ring;
+	if (rings.hmGet(topic, ring) && index < ring.count) {
+		auto &slot = ring.slots[(ring.head + index) % depth];
+		group = slot.group;
+		return slot.msg;
+	} else {
+		return nullptr;
+	}
+}
+
+unsigned int LastValues::count(unsigned int topic) const noexcept {
+	Ring ring;
+	if (rings.hmGet(topic, ring)) {
+		return ring.count;
+	} else {
+		return 0;
+	}
+}
+
+unsigned int LastValues::count() const noexcept {
+	return total;
+}
+
+void LastValues::clear() noexcept {
+	rings.iterate(release, this);
+	total = 0;
+}
+
+int LastValues::release(unsigned int index, void *arg) noexcept {
+	auto lv = static_cast<LastValues*>(arg);
+	auto ring = lv->rings.getValueReference(index);
+	for (unsigned int i = 0; i < ring->count; ++i) {
+		Message::recycle(ring->slots[(ring->head + i) % lv->depth].msg);
+	}
+	delete[] ring->slots;
+	return 1;
+}
+
+} /* namespace wanhive */
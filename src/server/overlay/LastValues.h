@@ -0,0 +1,81 @@
+/*
+ * LastValues.h
+ *
+ * Per-topic last-value cache
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_OVERLAY_LASTVALUES_H_
+#define WH_SERVER_OVERLAY_LASTVALUES_H_
+#include "../../base/ds/Khash.h"
+#include "../../util/Message.h"
+
+namespace wanhive {
+/**
+ * Retains the most recent publications of every topic so that they can be
+ * delivered to the late subscribers. Messages are shared (reference counted),
+ * at most <depth> messages are kept per topic and at most <limit> messages in
+ * total. Once the total limit is reached a topic can only replace its own
+ * messages, publications of the other topics are not cached.
+ * Thread safe at class level
+ */
+class LastValues {
+public:
+	LastValues() noexcept;
+	~LastValues();
+	//-----------------------------------------------------------------
+	//Keep up to <depth> (capped at MAX_DEPTH) messages per topic, 0 disables
+	void setDepth(unsigned int depth) noexcept;
+	//Returns the number of messages kept per topic
+	unsigned int getDepth() const noexcept;
+	//Keep at most <limit> messages in total
+	void setLimit(unsigned int limit) noexcept;
+	//Returns the limit on the total number of messages
+	unsigned int getLimit() const noexcept;
+	//-----------------------------------------------------------------
+	//Caches the <msg> published in the <group> to the <topic>
+	bool put(unsigned int topic, Message *msg, unsigned char group) noexcept;
+	/*
+	 * Returns the message at the given <index> (0 is the oldest) of the
+	 * <topic> and its <group>, nullptr if the index is out of range.
+	 */
+	Message* get(unsigned int topic, unsigned int index,
+			unsigned char &group) const noexcept;
+	//Returns the number of messages cached for the <topic>
+	unsigned int count(unsigned int topic) const noexcept;
+	//Returns the total number of messages in the cache
+	unsigned int count() const noexcept;
+	//Releases all the messages
+	void clear() noexcept;
+private:
+	static int release(unsigned int index, void *arg) noexcept;
+public:
+	//Maximum number of messages per topic
+	static constexpr unsigned int MAX_DEPTH = 64;
+private:
+	struct Slot {
+		Message *msg;
+		unsigned char group;
+	};
+
+	//Fixed size ring of the most recent messages
+	struct Ring {
+		Slot *slots;
+		unsigned int head;
+		unsigned int count;
+	};
+
+	Khash<unsigned int, Ring> rings;
+	unsigned int depth;
+	unsigned int limit;
+	unsigned int total;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_OVERLAY_LASTVALUES_H_ */
@@ -0,0 +1,234 @@
+/*
+ * Mailboxes.cpp
+ *
+ * Store and forward queues of the disconnected clients
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Mailboxes.h"
+#include "../../base/Timer.h"
+#include "../../base/common/BaseException.h"
+#include "../../base/ds/Twiddler.h"
+#include <new>
+
+namespace wanhive {
+
+Mailboxes::Mailboxes() noexcept :
+		depth(0), limit(0), ttl(0), total(0), journal { nullptr, 0 } {
+
+}
+
+Mailboxes::~Mailboxes() {
+	clear();
+}
+
+void Mailboxes::setDepth(unsigned int depth) noexcept {
+	depth = Twiddler::min(depth, MAX_DEPTH);
+	if (depth != this->depth) {
+		//The rings are sized for the old depth
+		clear();
+		this->depth = depth;
+	}
+}
+
+unsigned int Mailboxes::getDepth() const noexcept {
+	return depth;
+}
+
+void Mailboxes::setLimit(unsigned int limit) noexcept {
+	if (limit < total) {
+		clear();
+	}
+	this->limit = limit;
+}
+
+unsigned int Mailboxes::getLimit() const noexcept {
+	return limit;
+}
+
+void Mailboxes::setTTL(unsigned int ttl) noexcept {
+	this->ttl = ttl;
+}
+
+unsigned int Mailboxes::getTTL() const noexcept {
+	return ttl;
+}
+
+void Mailboxes::setJournal(const char *path, unsigned int size) noexcept {
+	if (path != journal.path || size != journal.size) {
+		//The existing journals use the old settings
+		clear();
+		journal.path = path;
+		journal.size = path ? size : 0;
+	}
+}
+
+unsigned int Mailboxes::getJournalSize() const noexcept {
+	return journal.size;
+}
+
+bool Mailboxes::put(unsigned long long id, Message *msg,
+		unsigned char group) noexcept {
+	if (!depth || !msg) {
+		return false;
+	}
+
+	auto i = boxes.get(id);
+	if (i == boxes.end()) {
+		if (total >= limit) {
+			return false;
+		}
+
+		int ret = 0;
+		Box box { new (std::nothrow) Slot[depth], 0, 0, nullptr, 0 };
+		if (!box.slots) {
+			return false;
+		} else if ((i = boxes.put(id, ret)) == boxes.end()
+				|| !boxes.setValue(i, box)) {
+			delete[] box.slots;
+			return false;
+		}
+	}
+
+	auto box = boxes.getValueReference(i);
+	auto journaled = box->journal && !box->journal->isEmpty();
+	if (!journaled && box->count < depth && total < limit) {
+		auto &slot = box->slots[(box->head + box->count) % depth];
+		slot.msg = msg;
+		slot.timestamp = Timer::timeStamp();
+		slot.group = group;
+		msg->addReferenceCount();
+		box->count += 1;
+		total += 1;
+		return true;
+	} else if (!journal.size) {
+		return false;
+	} else if (!box->journal
+			&& !(box->journal = new (std::nothrow) SpillQueue())) {
+		return false;
+	}
+
+	try {
+		if (!box->journal->isOpen()) {
+			box->journal->open(journal.path, journal.size);
+		}
+	} catch (const BaseException &e) {
+		return false;
+	}
+
+	//The journal preserves the group in the label
+	msg->updateLabel(group);
+	if (box->journal->put(msg)) {
+		box->timestamp = Timer::timeStamp();
+		return true;
+	} else {
+		return false;
+	}
+}
+
+Message* Mailboxes::get(unsigned long long id, unsigned char &group) noexcept {
+	auto i = boxes.get(id);
+	if (i == boxes.end()) {
+		return nullptr;
+	}
+
+	Message *msg = nullptr;
+	auto box = boxes.getValueReference(i);
+	if (box->count) {
+		auto &slot = box->slots[box->head];
+		msg = slot.msg;
+		group = slot.group;
+		box->head = (box->head + 1) % depth;
+		box->count -= 1;
+		total -= 1;
+	} else if (box->journal && !box->journal->isEmpty()
+			&& (msg = Message::create())) {
+		if (box->journal->get(msg)) {
+			//Hand over a reference, similar to the messages in memory
+			msg->addReferenceCount();
+			group = (unsigned char) msg->getLabel();
+			msg->putLabel(0);
+		} else {
+			Message::recycle(msg);
+			msg = nullptr;
+		}
+	}
+
+	if (!box->count && (!box->journal || box->journal->isEmpty())) {
+		delete[] box->slots;
+		delete box->journal;
+		boxes.remove(i);
+	}
+	return msg;
+}
+
+unsigned int Mailboxes::count(unsigned long long id) const noexcept {
+	Box box;
+	if (boxes.hmGet(id, box)) {
+		return box.count + (box.journal ? box.journal->count() : 0);
+	} else {
+		return 0;
+	}
+}
+
+unsigned int Mailboxes::count() const noexcept {
+	return total;
+}
+
+void Mailboxes::expire() noexcept {
+	Expiry expiry { this, Timer::timeStamp() };
+	boxes.iterate(releaseExpired, &expiry);
+}
+
+void Mailboxes::clear() noexcept {
+	boxes.iterate(release, this);
+	total = 0;
+}
+
+int Mailboxes::release(unsigned int index, void *arg) noexcept {
+	auto mb = static_cast<Mailboxes*>(arg);
+	auto box = mb->boxes.getValueReference(index);
+	for (unsigned int i = 0; i < box->count; ++i) {
+		Message::recycle(box->slots[(box->head + i) % mb->depth].msg);
+	}
+	delete[] box->slots;
+	delete box->journal;
+	return 1;
+}
+
+int Mailboxes::releaseExpired(unsigned int index, void *arg) noexcept {
+	auto expiry = static_cast<Expiry*>(arg);
+	auto mb = expiry->mailboxes;
+	auto box = mb->boxes.getValueReference(index);
+	//Timestamps are in microseconds, the TTL in milliseconds
+	auto ttl = mb->ttl * 1000ULL;
+	auto deadline = expiry->now - ttl;
+	if (ttl && expiry->now > ttl) {
+		while (box->count && box->slots[box->head].timestamp < deadline) {
+			Message::recycle(box->slots[box->head].msg);
+			box->head = (box->head + 1) % mb->depth;
+			box->count -= 1;
+			mb->total -= 1;
+		}
+
+		if (box->journal && box->timestamp < deadline) {
+			delete box->journal;
+			box->journal = nullptr;
+		}
+	}
+
+	if (!box->count && (!box->journal || box->journal->isEmpty())) {
+		delete[] box->slots;
+		delete box->journal;
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,109 @@
+/*
+ * Mailboxes.h
+ *
+ * Store and forward queues of the disconnected clients
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_OVERLAY_MAILBOXES_H_
+#define WH_SERVER_OVERLAY_MAILBOXES_H_
+#include "../../base/ds/Khash.h"
+#include "../../hub/SpillQueue.h"
+
+namespace wanhive {
+/**
+ * Holds the messages addressed to the clients which are not connected, so
+ * that they can be delivered after the client's registration. Messages are
+ * shared (reference counted), at most <depth> messages are kept in memory per
+ * client and at most <limit> messages in total. The excess messages of a
+ * mailbox can be moved into an optional, memory mapped journal. Messages
+ * expire after the TTL, the journal expires together with its most recent
+ * message.
+ * Thread safe at class level
+ */
+class Mailboxes {
+public:
+	Mailboxes() noexcept;
+	~Mailboxes();
+	//-----------------------------------------------------------------
+	//Keep up to <depth> (capped at MAX_DEPTH) messages per client, 0 disables
+	void setDepth(unsigned int depth) noexcept;
+	//Returns the number of messages kept in memory per client
+	unsigned int getDepth() const noexcept;
+	//Keep at most <limit> messages in memory in total
+	void setLimit(unsigned int limit) noexcept;
+	//Returns the limit on the total number of messages in memory
+	unsigned int getLimit() const noexcept;
+	//Messages expire after <ttl> milliseconds
+	void setTTL(unsigned int ttl) noexcept;
+	//Returns the messages' TTL in milliseconds
+	unsigned int getTTL() const noexcept;
+	//Journals of <size> bytes are created inside <path>, 0 <size> disables
+	void setJournal(const char *path, unsigned int size) noexcept;
+	//Returns the size of the journals in bytes
+	unsigned int getJournalSize() const noexcept;
+	//-----------------------------------------------------------------
+	//Holds the <msg> sent in the <group> to the client <id>
+	bool put(unsigned long long id, Message *msg, unsigned char group) noexcept;
+	/*
+	 * Removes the oldest message held for the client <id> and returns it along
+	 * with its <group>. The caller receives the mailbox's reference to the
+	 * message and must recycle it. Returns nullptr if the mailbox is empty.
+	 */
+	Message* get(unsigned long long id, unsigned char &group) noexcept;
+	//Returns the number of messages held for the client <id>
+	unsigned int count(unsigned long long id) const noexcept;
+	//Returns the total number of messages held in memory
+	unsigned int count() const noexcept;
+	//Releases the expired messages and the empty mailboxes
+	void expire() noexcept;
+	//Releases all the messages
+	void clear() noexcept;
+private:
+	static int release(unsigned int index, void *arg) noexcept;
+	static int releaseExpired(unsigned int index, void *arg) noexcept;
+public:
+	//Maximum number of messages per client in memory
+	static constexpr unsigned int MAX_DEPTH = 256;
+private:
+	struct Slot {
+		Message *msg;
+		unsigned long long timestamp;
+		unsigned char group;
+	};
+
+	//In memory ring of the oldest messages, followed by the journal
+	struct Box {
+		Slot *slots;
+		unsigned int head;
+		unsigned int count;
+		SpillQueue *journal;
+		//Time of the most recent addition to the journal
+		unsigned long long timestamp;
+	};
+
+	//Argument of the expiry callback
+	struct Expiry {
+		Mailboxes *mailboxes;
+		unsigned long long now;
+	};
+
+	Khash<unsigned long long, Box> boxes;
+	unsigned int depth;
+	unsigned int limit;
+	unsigned int ttl;
+	unsigned int total;
+	struct {
+		const char *path;
+		unsigned int size;
+	} journal;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_OVERLAY_MAILBOXES_H_ */
@@ -13,6 +13,7 @@
 #include "OverlayHub.h"
 #include "commands.h"
 #include "../../base/Logger.h"
+#include "../../hub/Topic.h"
 #include <cinttypes>
 
 namespace wanhive {
@@ -46,6 +47,45 @@ void OverlayHub::configure(void *arg) {
 		auto netmaskStr = conf.getString("OVERLAY", "netMask", "0x0");
 		sscanf(netmaskStr, "%llx", &ctx.netMask);
 		ctx.groupId = conf.getNumber("OVERLAY", "groupId");
+		ctx.shortcuts = conf.getNumber("OVERLAY", "shortcuts", 4);
+		ctx.shortcutThreshold = conf.getNumber("OVERLAY", "shortcutThreshold",
+				128);
+		ctx.shortcutDecay = conf.getNumber("OVERLAY", "shortcutDecay", 10000);
+		ctx.pingInterval = conf.getNumber("OVERLAY", "pingInterval",
+				ctx.updateCycle);
+		ctx.links = conf.getNumber("OVERLAY", "links", 1);
+		ctx.links = isSupernode() ? Twiddler::min(ctx.links, MAX_LINKS) : 1;
+		ctx.links = ctx.links ? ctx.links : 1;
+		ctx.linkFlows = conf.getNumber("OVERLAY", "linkFlows", 65536);
+		ctx.mapTimeout = conf.getNumber("OVERLAY", "mapTimeout", 2000);
+		ctx.lastValues = conf.getNumber("OVERLAY", "lastValues");
+		ctx.lastValuesLimit = conf.getNumber("OVERLAY", "lastValuesLimit",
+				1024);
+		ctx.conflationBacklog = conf.getNumber("OVERLAY", "conflationBacklog",
+				32);
+		ctx.subscriptions = conf.getNumber("OVERLAY", "subscriptions", 256);
+		ctx.subscriptionsLimit = conf.getNumber("OVERLAY",
+				"subscriptionsLimit", 65536);
+		ctx.mailboxDepth = conf.getNumber("OVERLAY", "mailboxDepth");
+		ctx.mailboxLimit = conf.getNumber("OVERLAY", "mailboxLimit", 1024);
+		ctx.mailboxTTL = conf.getNumber("OVERLAY", "mailboxTTL", 10000);
+		ctx.mailboxJournal = conf.getNumber("OVERLAY", "mailboxJournal");
+		ctx.mailboxPath = conf.getString("OVERLAY", "mailboxPath", "/tmp");
+		ctx.resumptionTTL = conf.getNumber("OVERLAY", "resumptionTTL");
+		ctx.handshakeRate = conf.getNumber("OVERLAY", "handshakeRate", 1024);
+		lastValues.setDepth(ctx.lastValues);
+		lastValues.setLimit(ctx.lastValuesLimit);
+		mailboxes.setDepth(ctx.mailboxDepth);
+		mailboxes.setLimit(ctx.mailboxLimit);
+		mailboxes.setTTL(ctx.mailboxTTL);
+		mailboxes.setJournal(ctx.mailboxPath, ctx.mailboxJournal);
+		resumption.setTTL(ctx.resumptionTTL);
+		shortcuts.setLimit(isSupernode() ? ctx.shortcuts : 0);
+		shortcuts.setThreshold(ctx.shortcutThreshold);
+		flows.setLimit(ctx.links > 1 ? ctx.linkFlows : 0);
+		flowTimer.now();
+		handshakes.set(ctx.handshakeRate, ctx.handshakeRate);
+		decayTimer.now();
 
 		if (!Identity::getIdentifiers("BOOTSTRAP", "nodes", ctx.bootstrapNodes,
 				WH_ARRAYLEN(ctx.bootstrapNodes))) {
@@ -55,11 +95,19 @@ void OverlayHub::configure(void *arg) {
 		}
 
 		WH_LOG_DEBUG(
-				"Overlay hub settings: \n" "ENABLE_REGISTRATION=%s, AUTHENTICATE_CLIENTS=%s, CONNECT_TO_OVERLAY=%s,\n" "TABLE_UPDATE_CYCLE=%ums, BLOCKING_IO_TIMEOUT=%ums, RETRY_INTERVAL=%ums,\n" "NETMASK=%s, GROUP_ID=%u\n",
+				"Overlay hub settings: \n" "ENABLE_REGISTRATION=%s, AUTHENTICATE_CLIENTS=%s, CONNECT_TO_OVERLAY=%s,\n" "TABLE_UPDATE_CYCLE=%ums, BLOCKING_IO_TIMEOUT=%ums, RETRY_INTERVAL=%ums,\n" "NETMASK=%s, GROUP_ID=%u,\n" "SHORTCUTS=%u, SHORTCUT_THRESHOLD=%u, SHORTCUT_DECAY=%ums, PING_INTERVAL=%ums,\n" "LINKS=%u, LINK_FLOWS=%u, MAP_TIMEOUT=%ums,\n" "LAST_VALUES=%u, LAST_VALUES_LIMIT=%u, CONFLATION_BACKLOG=%u,\n" "SUBSCRIPTIONS=%u, SUBSCRIPTIONS_LIMIT=%u,\n" "MAILBOX_DEPTH=%u, MAILBOX_LIMIT=%u, MAILBOX_TTL=%ums, MAILBOX_JOURNAL=%u,\n" "MAILBOX_PATH=%s, RESUMPTION_TTL=%ums, HANDSHAKE_RATE=%u\n",
 				WH_BOOLF(ctx.enableRegistration),
 				WH_BOOLF(ctx.authenticateClient),
 				WH_BOOLF(ctx.connectToOverlay), ctx.updateCycle,
-				ctx.requestTimeout, ctx.retryInterval, netmaskStr, ctx.groupId);
+				ctx.requestTimeout, ctx.retryInterval, netmaskStr, ctx.groupId,
+				shortcuts.getLimit(), ctx.shortcutThreshold, ctx.shortcutDecay,
+				ctx.pingInterval, ctx.links, ctx.linkFlows, ctx.mapTimeout,
+				lastValues.getDepth(), lastValues.getLimit(),
+				ctx.conflationBacklog, ctx.subscriptions,
+				ctx.subscriptionsLimit, mailboxes.getDepth(),
+				mailboxes.getLimit(), mailboxes.getTTL(),
+				mailboxes.getJournalSize(), ctx.mailboxPath,
+				resumption.getTTL(), ctx.handshakeRate);
 		installSettingsMonitor();
 		installService();
 	} catch (const BaseException &e) {
@@ -96,10 +144,17 @@ void OverlayHub::route(Message *message) noexcept {
 		if (qlf == WH_DHT_QLF_REGISTER) {
 			handleRegistrationRequest(message);
 			message->setGroup(0); //Ignore the group ID
+			prioritizeHandshake(message); //Registration result
 			return;
 		} else if (qlf == WH_DHT_QLF_GETKEY) {
 			handleGetKeyRequest(message);
 			message->setGroup(0); //Ignore the group ID
+			prioritizeHandshake(message); //Registration challenge
+			return;
+		} else if (qlf == WH_DHT_QLF_RESUME) {
+			handleResumeRequest(message);
+			message->setGroup(0); //Ignore the group ID
+			prioritizeHandshake(message); //Registration result
 			return;
 		}
 	}
@@ -109,12 +164,13 @@ void OverlayHub::route(Message *message) noexcept {
 	 */
 	auto origin = message->getOrigin();
 	auto source = message->getSource();
-	if (isExternalNode(origin) && !isWorkerId(origin)) {
+	if (isExternalNode(origin) && !isWorkerId(origin) && !isLinkId(origin)) {
 		//Preserve the group ID at insertion
 		message->updateLabel(message->getGroup());
 		//Assign the correct source ID
 		message->putSource(origin);
-	} else if (isInternalNode(origin) && isExternalNode(source)) {
+	} else if ((isInternalNode(origin) || isLinkId(origin))
+			&& isExternalNode(source)) {
 		//Retrieve the group ID during routing
 		message->setGroup(message->getLabel());
 	} else if (source && isInternalNode(source) && !isHostId(source)) {
@@ -131,6 +187,12 @@ void OverlayHub::route(Message *message) noexcept {
 		//Maintain this order
 		process(message); //Process the local request
 		message->setGroup(0); //Ignore the group ID
+	} else if (holdMessage(message)) {
+		//Held for a client which is expected to reconnect
+		message->setDestination(getUid());
+		message->setGroup(0); //Ignore the group ID
+		message->addReferenceCount(); //Account for Hub::publish
+		return;
 	}
 	//-----------------------------------------------------------------
 	/*
@@ -139,6 +201,11 @@ void OverlayHub::route(Message *message) noexcept {
 	if (isExternalNode(message->getDestination())) {
 		message->updateLabel(0); //Clean up the label
 	}
+
+	//Control traffic bypasses the data at the connections (see Socket)
+	if (isControlMessage(message)) {
+		message->setFlags(MSG_PRIORITY);
+	}
 }
 
 void OverlayHub::maintain() noexcept {
@@ -148,6 +215,46 @@ void OverlayHub::maintain() noexcept {
 			fixRoutingTable();
 		}
 	}
+
+	if (shortcuts.getLimit() && decayTimer.hasTimedOut(ctx.shortcutDecay)) {
+		decayTimer.now();
+		shortcuts.decay();
+	}
+
+	if (!shortcuts.isStable()) {
+		shortcuts.setStable(true);
+		fixShortcuts();
+	}
+
+	if (isSupernode() && ctx.pingInterval
+			&& pingTimer.hasTimedOut(ctx.pingInterval)) {
+		pingTimer.now();
+		fixProbe();
+		pingNeighbours();
+	}
+
+	if (ctx.links > 1 && linkTimer.hasTimedOut(ctx.updateCycle)) {
+		linkTimer.now();
+		fixLinks();
+	}
+
+	if (flows.count() && flowTimer.hasTimedOut(FLOW_EXPIRY)) {
+		flowTimer.now();
+		flows.expire();
+	}
+
+	if (mapTaskCount) {
+		expireMapTasks();
+	}
+
+	if (mailboxes.getDepth()) {
+		mailboxes.expire();
+	}
+
+	if (isSupernode() && treeTimer.hasTimedOut(ctx.updateCycle)) {
+		treeTimer.now();
+		fixTrees();
+	}
 }
 
 void OverlayHub::processInotification(unsigned long long uid,
@@ -251,6 +358,7 @@ void OverlayHub::installService() {
 		stabilizer.setConnection(fd);
 		stabilizer.setRetryInterval(ctx.retryInterval);
 		stabilizer.setUpdateCycle(ctx.updateCycle);
+		stabilizer.setShortcutLimit(shortcuts.getLimit());
 	} else {
 		//Worker thread not required
 	}
@@ -267,6 +375,10 @@ bool OverlayHub::fixRoutingTable() noexcept {
 		if (!isConsistent(i)) {
 			auto old = makeConsistent(i);
 			if (!isInRoute(old)) {
+				releaseLinks(old);
+			}
+
+			if (!isInRoute(old) && !shortcuts.contains(old)) {
 				auto conn = getWatcher(old);
 				//Take care of the reference asymmetry
 				if (conn && conn->isType(SOCKET_PROXY)) {
@@ -288,6 +400,162 @@ bool OverlayHub::fixRoutingTable() noexcept {
 	return true;
 }
 
+bool OverlayHub::fixShortcuts() noexcept {
+	for (unsigned int i = 0; i < Shortcuts::SIZE; i++) {
+		if (!shortcuts.isConsistent(i)) {
+			//Tear down the link which is no longer needed
+			auto old = shortcuts.makeConsistent(i);
+			if (old && !isInRoute(old) && !shortcuts.contains(old)) {
+				auto conn = getWatcher(old);
+				if (conn && conn->isType(SOCKET_PROXY)) {
+					disable(conn);
+				}
+			}
+		}
+
+		auto id = shortcuts.get(i);
+		if (id && !isHostId(id)) {
+			shortcuts.setConnected(i, connectToRoute(id, &scKeys[i]));
+		} else {
+			shortcuts.setConnected(i, false);
+		}
+	}
+	return true;
+}
+
+bool OverlayHub::fixProbe() noexcept {
+	//Tear down the link to the previous probe if it is no longer needed
+	auto old = latency.oldProbe;
+	if (old && old != latency.probe && !isInRoute(old)
+			&& !shortcuts.contains(old)) {
+		auto conn = getWatcher(old);
+		if (conn && conn->isType(SOCKET_PROXY)) {
+			disable(conn);
+		}
+	}
+	latency.oldProbe = latency.probe;
+	//-----------------------------------------------------------------
+	auto id = latency.probe;
+	if (!id) {
+		return true;
+	} else if (latency.rtt[id] || (++latency.rounds > 3)) {
+		//Measured or unreachable, release the probe
+		latency.probe = 0;
+		return true;
+	} else {
+		return connectToRoute(id, &latency.nonce);
+	}
+}
+
+bool OverlayHub::fixLinks() noexcept {
+	for (unsigned int i = 0; i < TABLESIZE; i++) {
+		auto id = get(i);
+		auto duplicate = false;
+		for (unsigned int j = 0; j < i && !duplicate; j++) {
+			duplicate = (get(j) == id);
+		}
+
+		if (!isConnected(i) || duplicate || isHostId(id) || isController(id)) {
+			continue;
+		}
+
+		//The primary link (index 0) is maintained by the routing table
+		for (unsigned int k = 1; k < ctx.links; k++) {
+			connectToRoute(linkId(id, k, false), &lKeys[i][k - 1]);
+		}
+	}
+	return true;
+}
+
+void OverlayHub::releaseLinks(unsigned long long id) noexcept {
+	if (!isInternalNode(id) || isHostId(id) || isController(id)) {
+		return;
+	}
+
+	for (unsigned int k = 1; k < MAX_LINKS; k++) {
+		auto conn = getWatcher(linkId(id, k, false));
+		if (conn && conn->isType(SOCKET_PROXY)) {
+			disable(conn);
+		}
+	}
+}
+
+void OverlayHub::pingNeighbours() noexcept {
+	//The fingers, predecessor, probe and shortcuts (duplicates are skipped)
+	unsigned int ids[TABLESIZE + Shortcuts::SIZE + 2];
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < TABLESIZE; i++) {
+		ids[count++] = isConnected(i) ? get(i) : 0;
+	}
+	ids[count++] = getPredecessor();
+	ids[count++] = latency.probe;
+	for (unsigned int i = 0; i < Shortcuts::SIZE; i++) {
+		ids[count++] = shortcuts.isConnected(i) ? shortcuts.get(i) : 0;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		auto id = ids[i];
+		auto duplicate = false;
+		for (unsigned int j = 0; j < i && !duplicate; j++) {
+			duplicate = (ids[j] == id);
+		}
+
+		if (id && !duplicate && !isHostId(id)) {
+			ping(id);
+		}
+	}
+}
+
+bool OverlayHub::ping(unsigned int id) noexcept {
+	auto conn = getWatcher(id);
+	if (!conn || !conn->testFlags(WATCHER_ACTIVE)) {
+		return false;
+	}
+
+	auto msg = Message::create(getUid());
+	if (!msg) {
+		return false;
+	}
+
+	//Queueing delay would distort the measurement
+	msg->setFlags(MSG_PRIORITY);
+	if (msg->putHeader(getUid(), id,
+			Message::HEADER_SIZE + sizeof(uint64_t), 0, 0, WH_DHT_CMD_OVERLAY,
+			WH_DHT_QLF_PING, WH_DHT_AQLF_REQUEST)
+			&& msg->setData64(0, Timer::timeStamp()) && sendMessage(msg)) {
+		return true;
+	} else {
+		Message::recycle(msg);
+		return false;
+	}
+}
+
+void OverlayHub::updateLatency(unsigned int id, unsigned int sample) noexcept {
+	if (id && id <= MAX_ID) {
+		auto &rtt = latency.rtt[id];
+		//Exponentially weighted moving average (alpha = 1/8)
+		rtt = rtt ? ((7ULL * rtt + sample) >> 3) : sample;
+		rtt = rtt ? rtt : 1;
+	}
+}
+
+void OverlayHub::expireMapTasks() noexcept {
+	for (unsigned int i = 0; i < MAP_TASKS; i++) {
+		auto &task = mapTasks[i];
+		if (task.tag && task.timer.hasTimedOut(task.timeout)) {
+			//Report the partial result
+			task.values[1] += task.pending;
+			task.pending = 0;
+			completeMapTask(i);
+		}
+	}
+}
+
+void OverlayHub::fixTrees() noexcept {
+	TreeWalk walk { this, 0 };
+	trees.iterate(walkTree, &walk);
+}
+
 bool OverlayHub::connectToRoute(unsigned long long id, Digest *hc) noexcept {
 	try {
 		return connect(id, hc);
@@ -348,7 +616,7 @@ Watcher* OverlayHub::createProxyConnection(unsigned long long id,
 		}
 
 		NameInfo ni;
-		Identity::getAddress(id, ni);
+		Identity::getAddress(isLinkId(id) ? linkOwner(id) : id, ni);
 		conn = new Socket(ni);
 		//-----------------------------------------------------------------
 		//A getKey request is automatically sent out
@@ -425,7 +693,17 @@ int OverlayHub::processRegistrationRequest(Message *message) noexcept {
 	} else {
 		conn->setGroup(message->getSession());
 		onRegistration(conn);
-		return (mode == 0) ? 1 : 0;
+		if (!mailboxes.count(newUid)) {
+			return (mode == 0) ? 1 : 0;
+		} else if (mode != 0 && conn->publish(message)) {
+			//The response goes out before the held messages
+			message->addReferenceCount(); //Account for Hub::publish
+			flushMailbox(conn);
+			return 1;
+		} else {
+			flushMailbox(conn);
+			return (mode == 0) ? 1 : 0;
+		}
 	}
 }
 
@@ -439,6 +717,9 @@ int OverlayHub::getModeOfRegistration(unsigned long long oldUid,
 	} else if (isInternalNode(newUid)) {
 		//Precedence Rule in case both sides are trying to connect (race condition)
 		return ((newUid < getUid()) ? 1 : 2);
+	} else if (isLinkId(newUid)) {
+		//Parallel links are directional, replace the stale one
+		return 2;
 	} else {
 		/*
 		 * Default case: Reserve a few connections in the pool for internal usage.
@@ -461,6 +742,10 @@ void OverlayHub::onRegistration(Watcher *w) noexcept {
 		w->setFlags(SOCKET_OVERLAY);
 		((Socket*) w)->setOutputQueueLimit(0);
 		Node::update(id, true);
+		shortcuts.update(id, true);
+	} else if (isLinkId(id)) {
+		w->setFlags(SOCKET_OVERLAY);
+		((Socket*) w)->setOutputQueueLimit(0);
 	} else {
 		return;
 	}
@@ -475,16 +760,83 @@ void OverlayHub::onRecycle(Watcher *w) noexcept {
 	//Remove from the routing table
 	if (isInternalNode(w->getUid())) {
 		Node::update(w->getUid(), false);
+		shortcuts.update(w->getUid(), false);
 	}
 
-	//Remove from the topics
+	//Remove from the topics (and the multicast trees)
 	if (w->testFlags(WATCHER_MULTICAST)) {
-		for (unsigned int i = 0; i < Topic::COUNT; i++) {
-			if (w->testTopic(i)) {
-				topics.remove(i, w);
-			}
+		unsigned int topic = 0;
+		while (topics.pop(w, topic)) {
+			updateTree(topic);
 		}
 	}
+
+	//Lost the parent, join again via the next hop
+	if (isInternalNode(w->getUid()) && isSupernode()) {
+		TreeWalk walk { this, (unsigned int) w->getUid() };
+		trees.iterate(walkTree, &walk);
+	}
+}
+
+bool OverlayHub::holdMessage(Message *message) noexcept {
+	auto destination = message->getDestination();
+	if (!mailboxes.getDepth() || message->testFlags(MSG_INVALID)
+			|| !isExternalNode(destination) || isController(destination)
+			|| Socket::isEphemeralId(destination)
+			|| !isLocal(mapKey(destination)) || getWatcher(destination)) {
+		return false;
+	} else {
+		return mailboxes.put(destination, message, message->getGroup());
+	}
+}
+
+void OverlayHub::flushMailbox(Watcher *w) noexcept {
+	unsigned char group = 0;
+	Message *msg = nullptr;
+	while ((msg = mailboxes.get(w->getUid(), group))) {
+		msg->updateLabel(0); //Clean up the label
+		if (!w->testGroup(group) && !w->publish(msg)
+				&& !((Socket*) w)->spill(msg)) {
+			WH_LOG_DEBUG("Held message to %llu dropped", w->getUid());
+		}
+		Message::recycle(msg);
+	}
+
+	if (w->isReady()) {
+		retain(w);
+	}
+}
+
+bool OverlayHub::isControlMessage(const Message *message) noexcept {
+	//Stabilization and ping, but not the multicast traffic
+	auto cmd = message->getCommand();
+	if (cmd == WH_DHT_CMD_MULTICAST || cmd > WH_DHT_CMD_OVERLAY) {
+		return false;
+	} else {
+		/*
+		 * Only among the hubs, the controller and the worker. The requests and
+		 * responses of the clients (possibly relayed by another hub) carry an
+		 * external source or destination and wait in line with the data.
+		 */
+		return isPrivileged(message->getOrigin())
+				&& isPrivileged(message->getDestination())
+				&& isPrivileged(message->getSource())
+				&& isPrivileged(
+						MessageHeader::getDestination(message->getStorage()));
+	}
+}
+
+void OverlayHub::prioritizeHandshake(Message *message) noexcept {
+	//The unauthenticated connections share a small budget
+	if (!ctx.handshakeRate) {
+		return;
+	}
+
+	handshakes.update(Timer::timeStamp() / 1000);
+	if (handshakes.isAvailable()) {
+		handshakes.consume(1);
+		message->setFlags(MSG_PRIORITY);
+	}
 }
 
 unsigned long long OverlayHub::getWorkerId() const noexcept {
@@ -600,7 +952,8 @@ int OverlayHub::removeIfInvalid(Watcher *w, void *arg) noexcept {
 	if (hub->counter.target && hub->counter.count >= hub->counter.target) {
 		return -1;
 	} else if (!(Socket::isEphemeralId(uid) || hub->isLocal(mapKey(uid))
-			|| hub->isInternalNode(uid) || hub->isWorkerId(uid))) {
+			|| hub->isInternalNode(uid) || hub->isWorkerId(uid)
+			|| isLinkId(uid))) {
 		hub->disable(w);
 		hub->counter.count++;
 		//No need to remove from the lookup table
@@ -615,7 +968,7 @@ int OverlayHub::removeIfClient(Watcher *w, void *arg) noexcept {
 	auto hub = static_cast<OverlayHub*>(arg);
 	if (hub->counter.target && hub->counter.count >= hub->counter.target) {
 		return -1;
-	} else if (isExternalNode(uid) && !hub->isWorkerId(uid)
+	} else if (isExternalNode(uid) && !hub->isWorkerId(uid) && !isLinkId(uid)
 			&& !(Socket::isEphemeralId(uid) && w->testFlags(WATCHER_ACTIVE))) {
 		hub->disable(w);
 		hub->counter.count++;
@@ -646,8 +999,16 @@ int OverlayHub::createRoute(Message *message) noexcept {
 			//Stabilization response returned via controller
 			message->setDestination(getWorkerId());
 		}
-	} else if (allowCommunication(origin, destination)) {
-		message->setDestination(getNextHop(destination));
+	} else if (allowCommunication(isLinkId(origin) ? linkOwner(origin) : origin,
+			destination)) {
+		auto hop = getNextHop(destination);
+		if (hop != destination) {
+			//Account for the forwarded traffic
+			shortcuts.record(mapKey(destination));
+			//Spread the client flows over the parallel links
+			hop = selectLink(hop, message->getSource(), destination);
+		}
+		message->setDestination(hop);
 	} else {
 		//Highly likely a miscommunication
 		if (!(isHostId(destination) || isController(destination))) {
@@ -667,17 +1028,80 @@ unsigned long long OverlayHub::getNextHop(
 	 * This is always the case with a stand-alone server
 	 *
 	 * CASE 2: Destination lies somewhere else on the network
-	 * FIND THE NEXT HOP
+	 * FIND THE NEXT HOP (a direct link to the root is preferred)
 	 */
 	auto k = mapKey(destination);
 	if (!isLocal(k) && !isController(destination)) {
 		//Case 2
-		return nextHop(k);
+		auto shortcut = shortcuts.nextHop(k);
+		return shortcut ? shortcut : nextHop(k);
 	} else {
 		return destination;
 	}
 }
 
+unsigned long long OverlayHub::selectLink(unsigned long long hop,
+		unsigned long long source, unsigned long long destination) noexcept {
+	if (ctx.links <= 1 || !isInternalNode(hop) || isController(hop)
+			|| !isExternalNode(source) || !isExternalNode(destination)) {
+		//Overlay traffic always takes the primary link
+		return hop;
+	}
+	//-----------------------------------------------------------------
+	/*
+	 * A flow stays on the link it started on, even if congested, which keeps
+	 * its messages in order. Only the new flows and the flows whose link has
+	 * been lost (or whose next hop has changed) go to the healthiest link.
+	 */
+	auto flow = Twiddler::mix(source ^ Twiddler::mix(destination));
+	unsigned long long link = 0;
+	if (flows.get(flow, link)
+			&& (link == hop
+					|| (isLinkId(link) && !isInboundLink(link)
+							&& linkOwner(link) == hop))) {
+		auto conn = getWatcher(link);
+		if (conn && conn->testFlags(WATCHER_ACTIVE)) {
+			return link;
+		}
+	}
+
+	link = healthiestLink(hop, flow);
+	if (flows.put(flow, link)) {
+		return link;
+	}
+	//-----------------------------------------------------------------
+	/*
+	 * Too many flows: fall back to the stateless per-flow hashing, the primary
+	 * link carries the flows of a missing link.
+	 */
+	auto index = (unsigned int) (flow % ctx.links);
+	auto id = index ? linkId(hop, index, false) : hop;
+	auto conn = getWatcher(id);
+	return (conn && conn->testFlags(WATCHER_ACTIVE)) ? id : hop;
+}
+
+unsigned long long OverlayHub::healthiestLink(unsigned long long hop,
+		unsigned long long flow) const noexcept {
+	//Start from the hashed link to spread the flows over the idle links
+	unsigned long long best = hop;
+	auto least = ~0U;
+	for (unsigned int i = 0; i < ctx.links; ++i) {
+		auto index = (unsigned int) ((flow + i) % ctx.links);
+		auto id = index ? linkId(hop, index, false) : hop;
+		auto conn = static_cast<Socket*>(getWatcher(id));
+		if (!conn || !conn->testFlags(WATCHER_ACTIVE)) {
+			continue;
+		}
+
+		auto load = conn->backlog() + conn->spilled();
+		if (load < least) {
+			best = id;
+			least = load;
+		}
+	}
+	return best;
+}
+
 bool OverlayHub::allowCommunication(unsigned long long source,
 		unsigned long long destination) const noexcept {
 	/*
@@ -721,15 +1145,19 @@ int OverlayHub::process(Message *message) noexcept {
 			return handleInvalidRequest(message);
 		}
 	case WH_DHT_CMD_MULTICAST:
-		if (isSupernode() || isInternalNode(origin)
-				|| Socket::isEphemeralId(origin)
+		//Overlay nodes send the multicast tree's traffic
+		if (Socket::isEphemeralId(origin) || isController(origin)
+				|| isWorkerId(origin) || isLinkId(origin)
+				|| (isInternalNode(origin) && !isSupernode())
 				|| status != WH_DHT_AQLF_REQUEST) {
 			return handleInvalidRequest(message);
-		} else if (qlf == WH_DHT_QLF_PUBLISH) {
+		} else if (qlf == WH_DHT_QLF_PUBLISH || qlf == WH_DHT_QLF_XPUBLISH) {
 			return handlePublishRequest(message);
-		} else if (qlf == WH_DHT_QLF_SUBSCRIBE) {
+		} else if (qlf == WH_DHT_QLF_SUBSCRIBE
+				|| qlf == WH_DHT_QLF_XSUBSCRIBE) {
 			return handleSubscribeRequest(message);
-		} else if (qlf == WH_DHT_QLF_UNSUBSCRIBE) {
+		} else if (qlf == WH_DHT_QLF_UNSUBSCRIBE
+				|| qlf == WH_DHT_QLF_XUNSUBSCRIBE) {
 			return handleUnsubscribeRequest(message);
 		} else {
 			return handleInvalidRequest(message);
@@ -754,18 +1182,28 @@ int OverlayHub::process(Message *message) noexcept {
 			return handleGetNeighboursRequest(message);
 		} else if (qlf == WH_DHT_QLF_NOTIFY) {
 			return handleNotifyRequest(message);
+		} else if (qlf == WH_DHT_QLF_GETSHORTCUT) {
+			return handleGetShortcutRequest(message);
+		} else if (qlf == WH_DHT_QLF_SETSHORTCUT) {
+			return handleSetShortcutRequest(message);
+		} else if (qlf == WH_DHT_QLF_GETLATENCY) {
+			return handleGetLatencyRequest(message);
 		} else {
 			return handleInvalidRequest(message);
 		}
 	case WH_DHT_CMD_OVERLAY:
-		if (!isPrivileged(origin) || status != WH_DHT_AQLF_REQUEST) {
+		if (!isPrivileged(origin)) {
 			return handleInvalidRequest(message);
-		} else if (qlf == WH_DHT_QLF_FINDSUCCESSOR) {
-			return handleFindSuccesssorRequest(message);
 		} else if (qlf == WH_DHT_QLF_PING) {
+			//Ping responses are processed too (RTT measurement)
 			return handlePingNodeRequest(message);
 		} else if (qlf == WH_DHT_QLF_MAP) {
+			//Partial results are returned up the broadcast tree
 			return handleMapRequest(message);
+		} else if (status != WH_DHT_AQLF_REQUEST) {
+			return handleInvalidRequest(message);
+		} else if (qlf == WH_DHT_QLF_FINDSUCCESSOR) {
+			return handleFindSuccesssorRequest(message);
 		} else {
 			return handleInvalidRequest(message);
 		}
@@ -938,7 +1376,13 @@ int OverlayHub::handleGetKeyRequest(Message *msg) noexcept {
 			//Convert the message into a Registration Request
 			Digest hc;
 			memcpy(&hc, msg->getBytes(Hash::SIZE), Hash::SIZE);
-			Protocol::createRegisterRequest(origin, getUid(), &hc, msg);
+			if (isLinkId(origin)) {
+				//Additional link: register as the matching inbound link
+				Protocol::createRegisterRequest(linkOwner(origin),
+						linkId(getUid(), linkIndex(origin), true), &hc, msg);
+			} else {
+				Protocol::createRegisterRequest(origin, getUid(), &hc, msg);
+			}
 			Protocol::sign(msg, getPKI());
 			//We are sending a registration request to the remote Node.
 			msg->setDestination(origin);
@@ -985,6 +1429,98 @@ int OverlayHub::handleGetKeyRequest(Message *msg) noexcept {
 	return 0;
 }
 
+int OverlayHub::handleResumeRequest(Message *msg) noexcept {
+	/*
+	 * HEADER: SRC=<REQUESTED ID>, DEST=X, ....CMD=1, QLF=4, AQLF=0/1/127
+	 * BODY: token followed by the encrypted [SECRET][NONCE] in Request (only
+	 * the encrypted [SECRET] if a registered client requests a token); a fresh
+	 * token (optional) in Response. The NONCE is obtained via GETKEY.
+	 * TOTAL: 32+337+256=625 bytes in Request; 32+337=369 bytes in Response
+	 */
+	auto origin = msg->getOrigin();
+	auto requestedUid = msg->getSource();
+	if (msg->getStatus() != WH_DHT_AQLF_REQUEST) {
+		return handleInvalidRequest(msg);
+	}
+
+	unsigned char secret[PKI::ENCODING_LENGTH]; //[SECRET][NONCE]
+	memset(secret, 0, sizeof(secret));
+	//-----------------------------------------------------------------
+	/*
+	 * [TOKEN REQUEST]
+	 * A registered client asks for a token for the future reconnection
+	 */
+	if (!Socket::isEphemeralId(origin)) {
+		if (!isExternalNode(origin) || isPrivileged(origin) || isLinkId(origin)
+				|| isController(origin)
+				|| msg->getPayloadLength() != PKI::ENCRYPTED_LENGTH) {
+			return handleInvalidRequest(msg);
+		}
+
+		auto success = getPKI()
+				&& getPKI()->decrypt((const PKIEncryptedData*) msg->getBytes(0),
+						secret);
+		msg->updateSource(0);
+		msg->updateDestination(0);
+		msg->setDestination(origin);
+		msg->putLength(Message::HEADER_SIZE);
+		if (success
+				&& resumption.issue(origin, msg->getGroup(),
+						(const Digest*) secret, getPKI(), msg)) {
+			msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+		} else {
+			msg->putStatus(WH_DHT_AQLF_REJECTED);
+		}
+		memset(secret, 0, sizeof(secret));
+		return 0;
+	}
+	//-----------------------------------------------------------------
+	/*
+	 * [RESUMPTION]
+	 * Treat the token as a signed registration request. Similar to the
+	 * registration, the proof must carry the nonce bound to this connection.
+	 */
+	//Trap this message before publishing to the remote host
+	msg->setFlags(MSG_TRAP);
+	unsigned long long uid = 0;
+	unsigned char group = 0;
+	auto success = getPKI()
+			&& msg->getPayloadLength()
+					== Resumption::SIZE + PKI::ENCRYPTED_LENGTH
+			&& getPKI()->decrypt(
+					(const PKIEncryptedData*) msg->getBytes(Resumption::SIZE),
+					secret)
+			&& verifyNonce(hashFn, origin, getUid(),
+					(const Digest*) (secret + Hash::SIZE))
+			&& resumption.redeem(msg, (const Digest*) secret, getPKI(), uid,
+					group) && uid == requestedUid
+			&& allowRegistration(origin, uid) && !isInternalNode(uid)
+			&& !isLinkId(uid);
+	//Set the source to this message's origin (Server performs source check)
+	msg->setSource(origin);
+	msg->updateSource(0);
+	msg->updateDestination(0);
+	msg->putLength(Message::HEADER_SIZE);
+	if (success) {
+		WH_LOG_DEBUG("Resumption request %" PRIu64"->%" PRIu64" approved",
+				origin, requestedUid);
+		//Request Accepted, message will be delivered on new UID
+		msg->setDestination(uid);
+		msg->updateSession(group);
+		//A fresh token for the next reconnection (best effort)
+		resumption.issue(uid, group, (const Digest*) secret, getPKI(), msg);
+		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+	} else {
+		WH_LOG_DEBUG("Resumption request %" PRIu64"->%" PRIu64" denied",
+				origin, requestedUid);
+		//Request denied, regret message will be sent on old ID
+		msg->setDestination(origin);
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+	}
+	memset(secret, 0, sizeof(secret));
+	return 0;
+}
+
 int OverlayHub::handleFindRootRequest(Message *msg) noexcept {
 	/*
 	 * HEADER: SRC=0, DEST=X, ....CMD=1, QLF=2, AQLF=0/1/127
@@ -1091,82 +1627,411 @@ int OverlayHub::handleBootstrapRequest(Message *msg) noexcept {
 //=================================================================
 int OverlayHub::handlePublishRequest(Message *msg) noexcept {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=0, AQLF=0/1/127
-	 * BODY: variable in Request; no Response
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=0/3, AQLF=0/1/127
+	 * BODY: variable in Request (4 bytes as <topic> first if QLF=3); no Response
 	 * TOTAL: at least 32 bytes in Request; no Response
 	 */
-	Watcher *sub = nullptr;
+	unsigned int topic = 0;
+	if (!getTopic(msg, topic)) {
+		return handleInvalidRequest(msg);
+	}
+
+	auto origin = msg->getOrigin();
+	auto source = msg->getSource();
+	//Publications received from the overlay carry the hop count in the label
+	auto hops =
+			isInternalNode(origin) ?
+					(unsigned int) ((msg->getLabel() >> 8) & 0xff) : 0;
+	auto forward = isSupernode() && (hops < MAX_TREE_HOPS);
+	//-----------------------------------------------------------------
+	/*
+	 * Deliver to the local subscribers and to the children (each tree edge is
+	 * crossed only once: the publication never goes back to where it came from)
+	 */
+	const Topics::Subscriber *entry = nullptr;
 	unsigned int index = 0;
-	auto topic = msg->getSession();
-	while ((sub = topics.get(topic, index))) {
-		if (sub->getUid() != msg->getOrigin()
-				&& checkMask(msg->getOrigin(), sub->getUid())
-				&& !sub->testGroup(msg->getGroup()) && sub->publish(msg)
-				&& sub->isReady()) {
+	while ((entry = topics.get(topic, index++))) {
+		auto sub = entry->w;
+		auto uid = sub->getUid();
+		if (isInternalNode(uid)) {
+			if (forward && uid != origin) {
+				forwardPublication(msg, uid, hops + 1);
+			}
+		} else if (uid != source && checkMask(source, uid)
+				&& !sub->testGroup(msg->getGroup())
+				&& testFilter(msg, entry->filter)
+				&& (conflate(sub, msg, topic, entry->conflation)
+						|| sub->publish(msg)) && sub->isReady()) {
 			retain(sub);
 		}
-		++index;
+	}
+	//-----------------------------------------------------------------
+	/*
+	 * Send up to the parent, or towards the root if this hub is off the tree
+	 */
+	auto key = topicKey(topic);
+	Tree tree { 0, false };
+	trees.hmGet(topic, tree);
+	if (!forward) {
+		//Local delivery only
+	} else if (tree.joined) {
+		if (tree.parent != origin) {
+			forwardPublication(msg, tree.parent, hops + 1);
+		}
+	} else if (!topics.count(topic) && !isLocal(key)) {
+		auto hop = nextHop(key);
+		if (hop != origin && !isHostId(hop) && !isController(hop)) {
+			forwardPublication(msg, hop, hops + 1);
+		}
 	}
 
 	msg->updateLabel(0); //Clean up internal information
 	msg->updateDestination(0); //There are multiple destinations
 	msg->updateStatus(WH_DHT_AQLF_ACCEPTED); //Prevent rebound
 	msg->addReferenceCount(); //Account for Hub::publish
+	lastValues.put(topic, msg, msg->getGroup());
 	return 0;
 }
 
 int OverlayHub::handleSubscribeRequest(Message *msg) noexcept {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=1, AQLF=0/1/127
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=1/4, AQLF=0/1/127
 	 * BODY: 0 in Request; 0 in Response
+	 * If QLF=4: 4 bytes as <topic> + optional 20 bytes as <filter> + optional
+	 * 4 bytes as <conflation> in Request; 4 bytes as <topic> in Response
 	 * TOTAL: 32 bytes in Request; 32 bytes in Response
+	 * If QLF=4: 36, 56 or 60 bytes in Request; 36 bytes in Response
 	 */
-	if (msg->getLength() != Message::HEADER_SIZE) {
+	unsigned int topic = 0;
+	if (!getTopic(msg, topic)) {
 		return handleInvalidRequest(msg);
 	}
 
-	auto topic = msg->getSession();
-	Socket *conn = (Socket*) getWatcher(msg->getOrigin());
-	buildResponseHeader(msg, Message::HEADER_SIZE);
+	auto extended = (msg->getQualifier() == WH_DHT_QLF_XSUBSCRIBE);
+	auto length = msg->getPayloadLength();
+	TopicFilter filter;
+	filter.clear();
+	Conflation conflation;
+	conflation.clear();
+	if (extended && length > sizeof(uint32_t)
+			&& !filter.unpack(msg->getBytes(sizeof(uint32_t)))) {
+		return handleInvalidRequest(msg);
+	} else if (extended && length > sizeof(uint32_t) + TopicFilter::SIZE
+			&& !conflation.unpack(
+					msg->getBytes(sizeof(uint32_t) + TopicFilter::SIZE))) {
+		return handleInvalidRequest(msg);
+	}
+
+	auto origin = msg->getOrigin();
+	Socket *conn = (Socket*) getWatcher(origin);
+	buildResponseHeader(msg,
+			Message::HEADER_SIZE + (extended ? sizeof(uint32_t) : 0));
 	msg->updateSource(0); //Obfuscate the source (this hub)
 
+	auto subscribed = conn && topics.contains(topic, conn);
 	if (!conn) {
 		return handleInvalidRequest(msg);
-	} else if (conn->testTopic(topic)) {
-		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
-	} else if (topics.put(topic, conn)) {
-		conn->setTopic(topic);
+	} else if (!subscribed && !admitSubscription(conn)) {
+		//Too many subscriptions
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+	} else if (topics.put(topic, conn, &filter, &conflation)) {
+		conn->setFlags(WATCHER_MULTICAST);
 		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
 	} else {
 		msg->putStatus(WH_DHT_AQLF_REJECTED);
 	}
+
+	//Join the topic's tree before answering from the cache
+	updateTree(topic);
+	if (!subscribed && isExternalNode(origin) && topics.contains(topic, conn)
+			&& lastValues.count(topic) && conn->publish(msg)) {
+		//Queue the response first, followed by the cached publications
+		msg->updateLabel(0);
+		Message *m = nullptr;
+		unsigned char group = 0;
+		for (unsigned int i = 0; (m = lastValues.get(topic, i, group)); ++i) {
+			auto source = m->getSource();
+			if (source != origin && checkMask(source, origin)
+					&& !conn->testGroup(group) && testFilter(m, filter)
+					&& !conn->publish(m)) {
+				break;
+			}
+		}
+
+		if (conn->isReady()) {
+			retain(conn);
+		}
+		msg->setDestination(getUid()); //Already queued up
+		msg->addReferenceCount(); //Account for Hub::publish
+		return 0;
+	}
+
+	if (isInternalNode(origin)) {
+		//A child has joined the tree, no response
+		msg->setDestination(getUid());
+	}
 	return 0;
 }
 
 int OverlayHub::handleUnsubscribeRequest(Message *msg) noexcept {
 	/*
-	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=2, AQLF=0/1/127
-	 * BODY: 0 in Request; 0 in Response
-	 * TOTAL: 32 bytes in Request; 32 bytes in Response
+	 * HEADER: SRC=0, DEST=X, ....CMD=2, QLF=2/5, AQLF=0/1/127
+	 * BODY: 0 in Request; 0 in Response (4 bytes as <topic> if QLF=5)
+	 * TOTAL: 32 bytes in Request; 32 bytes in Response (36 bytes if QLF=5)
 	 */
-	if (msg->getLength() != Message::HEADER_SIZE) {
+	unsigned int topic = 0;
+	if (!getTopic(msg, topic)) {
 		return handleInvalidRequest(msg);
 	}
 
-	auto topic = msg->getSession();
-	Socket *conn = (Socket*) getWatcher(msg->getOrigin());
+	auto origin = msg->getOrigin();
+	Socket *conn = (Socket*) getWatcher(origin);
 
-	if (conn && conn->testTopic(topic)) {
-		conn->clearTopic(topic);
+	if (conn && topics.contains(topic, conn)) {
 		topics.remove(topic, conn);
+		if (!topics.count(conn)) {
+			conn->clearFlags(WATCHER_MULTICAST);
+		}
 	}
 
-	buildResponseHeader(msg, Message::HEADER_SIZE);
+	buildResponseHeader(msg, msg->getLength());
 	msg->updateSource(0); //Obfuscate the source (this hub)
 	msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+
+	updateTree(topic);
+	if (isInternalNode(origin)) {
+		//A child has left the tree, no response
+		msg->setDestination(getUid());
+	}
 	return 0;
 }
 
+bool OverlayHub::admitSubscription(const Watcher *w) const noexcept {
+	if (ctx.subscriptionsLimit && topics.count() >= ctx.subscriptionsLimit) {
+		return false;
+	} else if (ctx.subscriptions && isExternalNode(w->getUid())
+			&& topics.count(w) >= ctx.subscriptions) {
+		return false;
+	} else {
+		return true;
+	}
+}
+
+bool OverlayHub::updateTree(unsigned int topic, bool refresh) noexcept {
+	if (!isSupernode()) {
+		return false;
+	}
+
+	auto i = trees.get(topic);
+	if (i == trees.end() && !topics.count(topic)) {
+		//Neither on the tree nor joined
+		return false;
+	}
+
+	int ret = 0;
+	if (i == trees.end()
+			&& ((i = trees.put(topic, ret)) == trees.end()
+					|| !trees.setValue(i, { 0, false }))) {
+		return false;
+	}
+
+	auto tree = trees.getValueReference(i);
+	auto onTree = updateTree(topic, *tree, refresh);
+	if (!onTree && !tree->joined) {
+		trees.remove(i);
+	}
+	return onTree;
+}
+
+bool OverlayHub::updateTree(unsigned int topic, Tree &tree,
+		bool refresh) noexcept {
+	auto key = topicKey(topic);
+	auto onTree = topics.count(topic) != 0;
+	//The root has no parent
+	unsigned int parent = 0;
+	if (onTree && !isLocal(key)) {
+		auto hop = nextHop(key);
+		parent = (isHostId(hop) || isController(hop)) ? 0 : hop;
+	}
+	//-----------------------------------------------------------------
+	if (tree.joined && tree.parent != parent) {
+		//Leave the old parent
+		sendTreeRequest(tree.parent, topic, false);
+		tree.joined = false;
+	}
+
+	if (parent && (!tree.joined || refresh)) {
+		//Join (or refresh the membership)
+		tree.joined = sendTreeRequest(parent, topic, true);
+		tree.parent = parent;
+	}
+	return onTree;
+}
+
+int OverlayHub::walkTree(unsigned int index, void *arg) noexcept {
+	auto walk = (TreeWalk*) arg;
+	auto hub = walk->hub;
+	unsigned int topic = 0;
+	auto tree = hub->trees.getValueReference(index);
+	if (!tree || !hub->trees.getKey(index, topic)) {
+		return 0;
+	}
+
+	bool onTree;
+	if (!walk->parent) {
+		onTree = hub->updateTree(topic, *tree, true);
+	} else if (tree->joined && tree->parent == walk->parent) {
+		//Lost the parent, join again via the next hop
+		tree->joined = false;
+		onTree = hub->updateTree(topic, *tree, false);
+	} else {
+		return 0;
+	}
+	//Remove the stale entry
+	return (onTree || tree->joined) ? 0 : 1;
+}
+
+bool OverlayHub::sendTreeRequest(unsigned int id, unsigned int topic,
+		bool join) noexcept {
+	auto conn = getWatcher(id);
+	if (!conn || !conn->testFlags(WATCHER_ACTIVE)) {
+		return false;
+	}
+
+	//Use the extended format only if the topic doesn't fit in the header
+	auto extended = (topic > Topic::MAX_ID);
+	uint8_t qlf;
+	if (extended) {
+		qlf = join ? WH_DHT_QLF_XSUBSCRIBE : WH_DHT_QLF_XUNSUBSCRIBE;
+	} else {
+		qlf = join ? WH_DHT_QLF_SUBSCRIBE : WH_DHT_QLF_UNSUBSCRIBE;
+	}
+
+	auto msg = Message::create(getUid());
+	if (!msg) {
+		return false;
+	} else if (msg->putHeader(getUid(), id,
+			Message::HEADER_SIZE + (extended ? sizeof(uint32_t) : 0), 0,
+			extended ? 0 : topic, WH_DHT_CMD_MULTICAST, qlf,
+			WH_DHT_AQLF_REQUEST) && (!extended || msg->setData32(0, topic))
+			&& sendMessage(msg)) {
+		return true;
+	} else {
+		Message::recycle(msg);
+		return false;
+	}
+}
+
+bool OverlayHub::forwardPublication(const Message *msg, unsigned int id,
+		unsigned int hops) noexcept {
+	auto copy = Message::create(getUid());
+	if (!copy) {
+		return false;
+	}
+
+	MessageHeader header;
+	msg->getHeader(header);
+	header.setDestination(id);
+	header.setLabel(msg->getGroup() | ((hops & 0xff) << 8));
+	if (copy->pack(header, msg->getBytes(0)) && sendMessage(copy)) {
+		return true;
+	} else {
+		Message::recycle(copy);
+		return false;
+	}
+}
+
+unsigned int OverlayHub::topicKey(unsigned int topic) noexcept {
+	return static_cast<unsigned int>(Twiddler::mix((unsigned long long) topic)
+			& MAX_ID);
+}
+
+bool OverlayHub::testFilter(const Message *msg,
+		const TopicFilter &filter) noexcept {
+	if (filter.isEmpty()) {
+		return true;
+	}
+
+	unsigned int length = 0;
+	auto payload = getPublication(msg, length);
+	return filter.test(payload, length);
+}
+
+const unsigned char* OverlayHub::getPublication(const Message *msg,
+		unsigned int &length) noexcept {
+	//Skip the topic identifier
+	unsigned int offset =
+			(msg->getQualifier() == WH_DHT_QLF_XPUBLISH) ?
+					sizeof(uint32_t) : 0;
+	auto total = msg->getPayloadLength();
+	length = (total > offset) ? (total - offset) : 0;
+	return msg->getBytes(offset);
+}
+
+bool OverlayHub::conflate(Watcher *w, Message *msg, unsigned int topic,
+		const Conflation &conflation) noexcept {
+	auto conn = static_cast<Socket*>(w);
+	if (!conflation.isEnabled()
+			|| conn->backlog() < ctx.conflationBacklog) {
+		return false;
+	}
+
+	unsigned int length = 0;
+	auto payload = getPublication(msg, length);
+	ConflationKey key { topic, 0, &conflation };
+	return conflation.getKey(payload, length, key.value)
+			&& conn->replace(msg, matchPublication, &key);
+}
+
+bool OverlayHub::matchPublication(const Message *queued, void *arg) noexcept {
+	auto key = static_cast<const ConflationKey*>(arg);
+	auto qlf = queued->getQualifier();
+	unsigned int topic = 0;
+	unsigned int length = 0;
+	uint64_t value = 0;
+	/*
+	 * Only the publications distributed by this hub have no destination in
+	 * the serialized header (the deserialized one still holds this hub's
+	 * identifier, see handlePublishRequest).
+	 */
+	if (queued->getCommand() != WH_DHT_CMD_MULTICAST
+			|| (qlf != WH_DHT_QLF_PUBLISH && qlf != WH_DHT_QLF_XPUBLISH)
+			|| MessageHeader::getDestination(queued->getStorage()) != 0
+			|| !getTopic(queued, topic)
+			|| topic != key->topic) {
+		return false;
+	}
+
+	auto payload = getPublication(queued, length);
+	return key->conflation->getKey(payload, length, value)
+			&& value == key->value;
+}
+
+bool OverlayHub::getTopic(const Message *msg, unsigned int &topic) noexcept {
+	auto qlf = msg->getQualifier();
+	if (qlf == WH_DHT_QLF_XPUBLISH) {
+		return (msg->getLength() >= Message::HEADER_SIZE + sizeof(uint32_t))
+				&& msg->getData32(0, topic);
+	} else if (qlf == WH_DHT_QLF_XSUBSCRIBE) {
+		//Optionally followed by a content filter and the conflation settings
+		auto length = msg->getPayloadLength();
+		return (length == sizeof(uint32_t)
+				|| length == sizeof(uint32_t) + TopicFilter::SIZE
+				|| length
+						== sizeof(uint32_t) + TopicFilter::SIZE
+								+ Conflation::SIZE) && msg->getData32(0, topic);
+	} else if (qlf == WH_DHT_QLF_XUNSUBSCRIBE) {
+		return (msg->getLength() == Message::HEADER_SIZE + sizeof(uint32_t))
+				&& msg->getData32(0, topic);
+	} else if (qlf == WH_DHT_QLF_PUBLISH) {
+		topic = msg->getSession();
+		return true;
+	} else {
+		topic = msg->getSession();
+		return msg->getLength() == Message::HEADER_SIZE;
+	}
+}
+
 //=================================================================
 int OverlayHub::handleGetPredecessorRequest(Message *msg) noexcept {
 	/*
@@ -1326,6 +2191,89 @@ int OverlayHub::handleNotifyRequest(Message *msg) noexcept {
 	notify(msg->getData64(0));
 	return 0;
 }
+
+int OverlayHub::handleGetShortcutRequest(Message *msg) noexcept {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=8, AQLF=0/1/127
+	 * BODY: 4 bytes in Request as <index>; 4 bytes as <index> + 8 bytes
+	 * as <key> in Response
+	 * TOTAL: 32+4=36 bytes in Request; 32+4+8=44 bytes in Response
+	 */
+	if (msg->getPayloadLength() != sizeof(uint32_t)) {
+		return handleInvalidRequest(msg);
+	}
+
+	buildResponseHeader(msg,
+			Message::HEADER_SIZE + sizeof(uint32_t) + sizeof(uint64_t));
+	auto index = msg->getData32(0);
+	unsigned int key = 0;
+	if (shortcuts.getKey(index, key)) {
+		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+		msg->setData64(sizeof(uint32_t), key);
+	} else {
+		//Empty slot
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+		msg->setData64(sizeof(uint32_t), 0);
+	}
+	return 0;
+}
+
+int OverlayHub::handleSetShortcutRequest(Message *msg) noexcept {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=9, AQLF=0/1/127
+	 * BODY: 4 bytes as <index>, 8 bytes as <key> and 8 bytes as <root>
+	 * in Request and in Response
+	 * TOTAL: 32+4+8+8=52 bytes
+	 */
+	if (msg->getPayloadLength() != sizeof(uint32_t) + 2 * sizeof(uint64_t)) {
+		return handleInvalidRequest(msg);
+	}
+
+	buildResponseHeader(msg);
+	auto index = msg->getData32(0);
+	auto key = msg->getData64(sizeof(uint32_t));
+	auto root = msg->getData64(sizeof(uint32_t) + sizeof(uint64_t));
+
+	if (key <= MAX_ID && root && isInternalNode(root) && !isHostId(root)
+			&& shortcuts.set(index, key, root)) {
+		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+	} else {
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+	}
+	return 0;
+}
+
+int OverlayHub::handleGetLatencyRequest(Message *msg) noexcept {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=10, AQLF=0/1/127
+	 * BODY: 8 bytes as <key> in Request; 8 bytes as <key> + 4 bytes
+	 * as <round trip time> (microseconds) in Response
+	 * TOTAL: 32+8=40 bytes in Request; 32+8+4=44 bytes in Response
+	 */
+	if (msg->getPayloadLength() != sizeof(uint64_t)) {
+		return handleInvalidRequest(msg);
+	}
+
+	buildResponseHeader(msg,
+			Message::HEADER_SIZE + sizeof(uint64_t) + sizeof(uint32_t));
+	auto key = msg->getData64(0);
+	if (!key || key > MAX_ID || isHostId(key)) {
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+		msg->setData32(sizeof(uint64_t), 0);
+	} else if (latency.rtt[key]) {
+		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+		msg->setData32(sizeof(uint64_t), latency.rtt[key]);
+	} else {
+		//Not measured yet, probe the node in the background
+		if (!latency.probe) {
+			latency.probe = key;
+			latency.rounds = 0;
+		}
+		msg->putStatus(WH_DHT_AQLF_REJECTED);
+		msg->setData32(sizeof(uint64_t), 0);
+	}
+	return 0;
+}
 //=================================================================
 int OverlayHub::handleFindSuccesssorRequest(Message *msg) noexcept {
 	/*
@@ -1368,12 +2316,25 @@ int OverlayHub::handleFindSuccesssorRequest(Message *msg) noexcept {
 int OverlayHub::handlePingNodeRequest(Message *msg) noexcept {
 	/*
 	 * HEADER: SRC=0, DEST=X, ....CMD=4, QLF=1, AQLF=0/1/127
-	 * BODY: 0 bytes in Request and Response
-	 * TOTAL: 32 bytes in Request and Response
+	 * BODY: 0 or 8 bytes as <timestamp> in Request and Response (echoed back)
+	 * TOTAL: 32 or 32+8=40 bytes in Request and Response
 	 */
 	auto origin = msg->getOrigin();
 	//-----------------------------------------------------------------
-	if (isWorkerId(origin)) {
+	if (msg->getStatus() != WH_DHT_AQLF_REQUEST) {
+		//Response to a timestamped ping sent by this hub (see OverlayHub::ping)
+		if (msg->getStatus() == WH_DHT_AQLF_ACCEPTED && isInternalNode(origin)
+				&& msg->getPayloadLength() == sizeof(uint64_t)) {
+			auto timestamp = msg->getData64(0);
+			auto now = Timer::timeStamp();
+			if (now >= timestamp && (now - timestamp) <= 0xffffffffULL) {
+				updateLatency(origin, (unsigned int) (now - timestamp));
+			}
+		}
+		//Consume the response
+		msg->setDestination(getUid());
+		return 0;
+	} else if (isWorkerId(origin)) {
 		//Allows the worker to ask for maintenance
 		Node::setStable(false);
 		buildResponseHeader(msg);
@@ -1383,6 +2344,11 @@ int OverlayHub::handlePingNodeRequest(Message *msg) noexcept {
 		buildResponseHeader(msg);
 		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
 		return 0;
+	} else if (isInternalNode(origin) && msg->getSource() == origin) {
+		//Direct ping from an overlay neighbour, the timestamp is echoed back
+		buildResponseHeader(msg);
+		msg->putStatus(WH_DHT_AQLF_ACCEPTED);
+		return 0;
 	} else {
 		return handleInvalidRequest(msg);
 	}
@@ -1391,69 +2357,235 @@ int OverlayHub::handlePingNodeRequest(Message *msg) noexcept {
 int OverlayHub::handleMapRequest(Message *msg) noexcept {
 	/*
 	 * HEADER: SRC=0, DEST=X, ....CMD=4, QLF=2, AQLF=0/1/127
-	 * BODY: variable in Request; variable in Response
-	 * TOTAL: at least 32 bytes in Request and Response
+	 * BODY (requester): 4 bytes as <function> + 4 bytes as <timeout> in
+	 * Request; 4 bytes as <function> + 8*MAP_VALUES bytes as <values> in
+	 * Response
+	 * BODY (overlay): 4 bytes as <tag> + 4 bytes as <function> + 4 bytes as
+	 * <timeout> + 8 bytes as <limit> in Request; 4 bytes as <tag> + 4 bytes
+	 * as <function> + 8*MAP_VALUES bytes as <values> in Response
+	 * TOTAL (requester): 32+4+4=40 bytes in Request; 32+4+64=100 bytes in
+	 * Response
+	 * TOTAL (overlay): 32+20=52 bytes in Request; 32+8+64=104 bytes in Response
 	 */
 	auto origin = msg->getOrigin();
-	auto source = msg->getSource();
+	auto length = msg->getPayloadLength();
 	//-----------------------------------------------------------------
-	/*
-	 * Message insertion
-	 * At this point we are sure that this node was the intended recipient.
-	 */
-	if (isExternalNode(origin)) {
+	if (msg->getStatus() != WH_DHT_AQLF_REQUEST) {
+		return handleMapResponse(msg);
+	}
+
+	auto root = (isController(origin) || isWorkerId(origin))
+			&& length == 2 * sizeof(uint32_t);
+	auto internal = isInternalNode(origin) && !isController(origin)
+			&& length == 3 * sizeof(uint32_t) + sizeof(uint64_t);
+	if (!root && !internal) {
 		return handleInvalidRequest(msg);
-	} else if (isController(origin)) {
-		//Cache the source ID
-		if (msg->appendData64(source)) {
-			//Record the entry point
-			msg->putSource(getUid());
+	}
+
+	auto index = createMapTask();
+	if (index == MAP_TASKS) {
+		//Too many requests in progress
+		if (root) {
+			buildResponseHeader(msg, Message::HEADER_SIZE);
+			msg->putStatus(WH_DHT_AQLF_REJECTED);
+			return 0;
 		} else {
-			//Invalid message length
 			return handleInvalidRequest(msg);
 		}
-	} else if (isExternalNode(source) || origin != getPredecessor()
-			|| msg->getPayloadLength() < sizeof(uint64_t)) {
-		//Routing around the ring: invalid message
-		return handleInvalidRequest(msg);
+	}
+	//-----------------------------------------------------------------
+	auto &task = mapTasks[index];
+	if (root) {
+		//Inserted here, the whole ring is covered
+		auto timeout = msg->getData32(sizeof(uint32_t));
+		task.function = msg->getData32(0);
+		task.timeout =
+				timeout ?
+						Twiddler::min(timeout, ctx.requestTimeout) :
+						ctx.mapTimeout;
+		task.limit = mapKey(getUid());
+		task.root = true;
+		task.parent = origin;
+		task.parentTag = msg->getSource();
+		task.sequenceNumber = msg->getSequenceNumber();
+		task.session = msg->getSession();
+	} else {
+		//Root of a subtree
+		task.parentTag = msg->getData32(0);
+		task.function = msg->getData32(sizeof(uint32_t));
+		task.timeout = Twiddler::min(msg->getData32(2 * sizeof(uint32_t)),
+				ctx.requestTimeout);
+		task.limit = mapKey(msg->getData64(3 * sizeof(uint32_t)));
+		task.root = false;
+		task.parent = origin;
 	}
 	//-----------------------------------------------------------------
 	/*
-	 * Execute and forward
+	 * Execute locally and spread down the broadcast tree
 	 */
-	auto result = mapFunction(msg);
-	auto successor = getSuccessor();
-	if (result == 0
-			&& (isHostId(source) || !isInRange(source, getUid(), successor))
-			&& getUid() != successor) {
-		/*
-		 * Forward the Message around the DHT ring until it reaches
-		 * the predecessor of the node where the message was originally
-		 * inserted (or the hole).
-		 */
-		msg->putDestination(successor);
+	if (mapFunction(task.function, task.values)) {
+		task.values[0] += 1;
+		task.pending = forwardMapTask(index);
 	} else {
-		//Return back to the originator, final step
-		auto index = msg->getLength()
-				- (sizeof(uint64_t) + Message::HEADER_SIZE);
-		auto destination = msg->getData64(index);
-
-		msg->setDestination(0);
-		msg->updateDestination(destination);
-		msg->putSource(getUid());
-		msg->putLength(Message::HEADER_SIZE);
-		msg->putStatus(
-				(result == 0 || result == 1) ?
-						WH_DHT_AQLF_ACCEPTED : WH_DHT_AQLF_REJECTED);
+		task.values[1] += 1;
 	}
+
+	if (!task.pending) {
+		completeMapTask(index);
+	}
+	//The request has been consumed
+	msg->setDestination(getUid());
 	return 0;
 }
 
-int OverlayHub::mapFunction(Message *msg) noexcept {
-	WH_LOG_ALERT("~~Received a Map Request~~");
+int OverlayHub::handleMapResponse(Message *msg) noexcept {
+	auto origin = msg->getOrigin();
+	if (isInternalNode(origin) && !isController(origin)
+			&& msg->getStatus() == WH_DHT_AQLF_ACCEPTED
+			&& msg->getPayloadLength()
+					== 2 * sizeof(uint32_t) + MAP_VALUES * sizeof(uint64_t)) {
+		auto tag = msg->getData32(0);
+		auto function = msg->getData32(sizeof(uint32_t));
+		for (unsigned int i = 0; i < MAP_TASKS; i++) {
+			auto &task = mapTasks[i];
+			if (!tag || task.tag != tag || task.function != function
+					|| !task.pending) {
+				continue;
+			}
+			//Reduce the partial result
+			auto offset = 2 * sizeof(uint32_t);
+			for (unsigned int j = 0; j < MAP_VALUES; j++) {
+				task.values[j] += msg->getData64(offset);
+				offset += sizeof(uint64_t);
+			}
+
+			if (!(--task.pending)) {
+				completeMapTask(i);
+			}
+			break;
+		}
+	}
+	//Consume the response (late responses are dropped)
+	msg->setDestination(getUid());
 	return 0;
 }
 
+bool OverlayHub::mapFunction(unsigned int function, uint64_t *values) noexcept {
+	switch (function) {
+	case WH_DHT_MAP_NULL:
+		return true;
+	case WH_DHT_MAP_STATISTICS:
+		values[2] += Socket::allocated();
+		values[3] += Message::allocated();
+		values[4] += messagesReceived();
+		values[5] += bytesReceived();
+		values[6] += messagesDropped();
+		values[7] += bytesDropped();
+		return true;
+	default:
+		return false;
+	}
+}
+
+unsigned int OverlayHub::createMapTask() noexcept {
+	for (unsigned int i = 0; i < MAP_TASKS; i++) {
+		auto &task = mapTasks[i];
+		if (task.tag) {
+			continue;
+		}
+
+		if (!(++mapTag)) {
+			++mapTag;
+		}
+		task.tag = mapTag;
+		task.pending = 0;
+		memset(task.values, 0, sizeof(task.values));
+		task.timer.now();
+		++mapTaskCount;
+		return i;
+	}
+	return MAP_TASKS;
+}
+
+unsigned int OverlayHub::forwardMapTask(unsigned int index) noexcept {
+	auto &task = mapTasks[index];
+	//The fingers are sorted by their distance from this hub
+	unsigned int children[TABLESIZE];
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < TABLESIZE; i++) {
+		auto id = get(i);
+		if (isConnected(i) && !isHostId(id) && !isController(id)
+				&& isBetween(id, getUid(), task.limit)
+				&& (!count || children[count - 1] != id)) {
+			children[count++] = id;
+		}
+	}
+	//-----------------------------------------------------------------
+	//Each child covers the keys up to the next child (exclusive)
+	unsigned int sent = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		auto limit = (i + 1 < count) ? children[i + 1] : task.limit;
+		auto msg = Message::create(getUid());
+		if (msg
+				&& msg->putHeader(getUid(), children[i],
+						Message::HEADER_SIZE + 3 * sizeof(uint32_t)
+								+ sizeof(uint64_t), 0, 0, WH_DHT_CMD_OVERLAY,
+						WH_DHT_QLF_MAP, WH_DHT_AQLF_REQUEST)
+				&& msg->setData32(0, task.tag)
+				&& msg->setData32(sizeof(uint32_t), task.function)
+				//Allow the child to respond before this subtree times out
+				&& msg->setData32(2 * sizeof(uint32_t), (task.timeout * 3) / 4)
+				&& msg->setData64(3 * sizeof(uint32_t), limit)
+				&& sendMessage(msg)) {
+			++sent;
+		} else {
+			Message::recycle(msg);
+			task.values[1] += 1;
+		}
+	}
+	return sent;
+}
+
+void OverlayHub::completeMapTask(unsigned int index) noexcept {
+	auto &task = mapTasks[index];
+	auto msg = Message::create(getUid());
+	auto success = (msg != nullptr);
+	unsigned int offset = 0;
+	if (success && task.root) {
+		//Final result, sent to the requester via the original hop
+		success = msg->putHeader(getUid(), task.parentTag,
+				Message::HEADER_SIZE + sizeof(uint32_t)
+						+ MAP_VALUES * sizeof(uint64_t), task.sequenceNumber,
+				task.session, WH_DHT_CMD_OVERLAY, WH_DHT_QLF_MAP,
+				task.values[0] ? WH_DHT_AQLF_ACCEPTED : WH_DHT_AQLF_REJECTED)
+				&& msg->setData32(0, task.function);
+		msg->setDestination(task.parent);
+		offset = sizeof(uint32_t);
+	} else if (success) {
+		//Partial result, sent to the parent hub
+		success = msg->putHeader(getUid(), task.parent,
+				Message::HEADER_SIZE + 2 * sizeof(uint32_t)
+						+ MAP_VALUES * sizeof(uint64_t), 0, 0,
+				WH_DHT_CMD_OVERLAY, WH_DHT_QLF_MAP, WH_DHT_AQLF_ACCEPTED)
+				&& msg->setData32(0, (uint32_t) task.parentTag)
+				&& msg->setData32(sizeof(uint32_t), task.function);
+		offset = 2 * sizeof(uint32_t);
+	}
+
+	for (unsigned int i = 0; success && i < MAP_VALUES; i++) {
+		success = msg->setData64(offset, task.values[i]);
+		offset += sizeof(uint64_t);
+	}
+
+	if (!success || !sendMessage(msg)) {
+		Message::recycle(msg);
+	}
+	//Release the slot
+	task.tag = 0;
+	task.pending = 0;
+	--mapTaskCount;
+}
+
 //=================================================================
 bool OverlayHub::checkMask(unsigned long long source,
 		unsigned long long destination) const noexcept {
@@ -1476,12 +2608,13 @@ bool OverlayHub::isValidRegistrationRequest(const Message *msg) noexcept {
 	if (!allowRegistration(origin, requestedId)) {
 		//CASE 1
 		return false;
-	} else if (!ctx.authenticateClient && !isInternalNode(requestedId)) {
+	} else if (!ctx.authenticateClient && !isInternalNode(requestedId)
+			&& !isLinkId(requestedId)) {
 		//CASE 2
 		return true;
 	} else if (!getPKI()) {
-		//CASE 2
-		return true;
+		//CASE 2: the parallel links can't be told apart from the clients
+		return !isLinkId(requestedId);
 	} else if (msg->getPayloadLength() == Hash::SIZE + PKI::SIGNATURE_LENGTH) {
 		//CASE 2
 		return verifyNonce(hashFn, origin, getUid(), (Digest*) msg->getBytes(0))
@@ -1497,7 +2630,8 @@ bool OverlayHub::allowRegistration(unsigned long long source,
 	 * 1. Registration should be enabled
 	 * 2. Only fresh request and the Requested ID must be an Active ID
 	 * 3. Requested ID cannot be one of the Host/Controller/Worker IDs
-	 * 4. Requested Client ID must be "local"
+	 * 4. Parallel links are accepted from the overlay nodes only
+	 * 5. Requested Client ID must be "local"
 	 */
 	if (!ctx.enableRegistration) {
 		//CASE 1
@@ -1510,8 +2644,14 @@ bool OverlayHub::allowRegistration(unsigned long long source,
 			|| isWorkerId(requestedId)) {
 		//CASE 3
 		return false;
-	} else if (isExternalNode(requestedId) && !isLocal(mapKey(requestedId))) {
+	} else if (isLinkId(requestedId)) {
 		//CASE 4
+		auto owner = linkOwner(requestedId);
+		return isSupernode() && isInboundLink(requestedId)
+				&& linkIndex(requestedId) && !isController(owner)
+				&& !isHostId(owner);
+	} else if (isExternalNode(requestedId) && !isLocal(mapKey(requestedId))) {
+		//CASE 5
 		return false;
 	} else {
 		return true;
@@ -1540,6 +2680,24 @@ unsigned long long OverlayHub::nonceToId(const Digest *nonce) const noexcept {
 		return get(i);
 	} else if (i == TABLESIZE) {
 		return CONTROLLER;
+	}
+
+	for (i = 0; i < Shortcuts::SIZE; i++) {
+		if (memcmp(nonce, &scKeys[i], sizeof(Digest)) == 0) {
+			return shortcuts.get(i);
+		}
+	}
+
+	for (i = 0; i < TABLESIZE; i++) {
+		for (unsigned int k = 0; k < (MAX_LINKS - 1); k++) {
+			if (memcmp(nonce, &lKeys[i][k], sizeof(Digest)) == 0) {
+				return linkId(get(i), k + 1, false);
+			}
+		}
+	}
+
+	if (memcmp(nonce, &latency.nonce, sizeof(Digest)) == 0) {
+		return latency.probe;
 	} else {
 		return getUid();
 	}
@@ -1573,14 +2731,28 @@ void OverlayHub::clear() noexcept {
 	memset(&ctx, 0, sizeof(ctx));
 	memset(&nodes, 0, sizeof(nodes));
 	memset(sKeys, 0, sizeof(sKeys));
+	memset(scKeys, 0, sizeof(scKeys));
+	memset(lKeys, 0, sizeof(lKeys));
+	memset(&latency, 0, sizeof(latency));
 	memset(&counter, 0, sizeof(counter));
+	for (unsigned int i = 0; i < MAP_TASKS; i++) {
+		mapTasks[i].tag = 0;
+		mapTasks[i].pending = 0;
+	}
+	mapTaskCount = 0;
+	mapTag = 0;
 
 	for (unsigned int i = 0; i < 8; i++) {
 		wd[i].identifier = -1;
 		wd[i].events = 0;
 	}
 
+	trees.clear();
+	lastValues.clear();
 	topics.clear();
+	shortcuts.clear();
+	flows.clear();
+	resumption.clear();
 }
 
 bool OverlayHub::isHostId(unsigned long long uid) const noexcept {
@@ -1608,4 +2780,26 @@ unsigned int OverlayHub::mapKey(unsigned long long key) noexcept {
 	}
 }
 
+unsigned long long OverlayHub::linkId(unsigned int id, unsigned int index,
+		bool inbound) noexcept {
+	unsigned long long slot = (inbound ? MAX_LINKS : 0) + (index % MAX_LINKS);
+	return LINK_BASE + (slot * MAX_NODES) + (id & MAX_ID);
+}
+
+bool OverlayHub::isLinkId(unsigned long long uid) noexcept {
+	return uid >= LINK_BASE && uid <= Socket::MAX_ACTIVE_ID;
+}
+
+bool OverlayHub::isInboundLink(unsigned long long uid) noexcept {
+	return isLinkId(uid) && ((uid - LINK_BASE) / MAX_NODES) >= MAX_LINKS;
+}
+
+unsigned int OverlayHub::linkOwner(unsigned long long uid) noexcept {
+	return static_cast<unsigned int>((uid - LINK_BASE) & MAX_ID);
+}
+
+unsigned int OverlayHub::linkIndex(unsigned long long uid) noexcept {
+	return static_cast<unsigned int>(((uid - LINK_BASE) / MAX_NODES) % MAX_LINKS);
+}
+
 } /* namespace wanhive */
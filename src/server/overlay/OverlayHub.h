@@ -12,7 +12,12 @@
 
 #ifndef WH_SERVER_OVERLAY_OVERLAYHUB_H_
 #define WH_SERVER_OVERLAY_OVERLAYHUB_H_
+#include "Flows.h"
+#include "LastValues.h"
+#include "Mailboxes.h"
+#include "Resumption.h"
 #include "Topics.h"
+#include "Shortcuts.h"
 #include "OverlayService.h"
 #include "../../hub/Hub.h"
 
@@ -38,6 +43,8 @@ private:
 	void maintain() noexcept override final;
 	void processInotification(unsigned long long uid,
 			const InotifyEvent *event) noexcept override final;
+	//Can the connection <uid> send privileged requests
+	bool isPrivileged(unsigned long long uid) const noexcept override final;
 	bool enableWorker() const noexcept override final;
 	void doWork(void *arg) noexcept override final;
 	void stopWork() noexcept override final;
@@ -49,6 +56,22 @@ private:
 	//Used by <maintain>
 	bool fixController() noexcept;
 	bool fixRoutingTable() noexcept;
+	bool fixShortcuts() noexcept;
+	bool fixProbe() noexcept;
+	//Establish the additional parallel links to the fingers
+	bool fixLinks() noexcept;
+	//Tear down the additional parallel links to the node <id>
+	void releaseLinks(unsigned long long id) noexcept;
+	//Send timestamped pings to the directly connected overlay nodes
+	void pingNeighbours() noexcept;
+	//Send a timestamped ping to the overlay node <id>
+	bool ping(unsigned int id) noexcept;
+	//Update the smoothed round trip time of the node <id> with the <sample>
+	void updateLatency(unsigned int id, unsigned int sample) noexcept;
+	//Complete the map tasks whose subtrees failed to respond in time
+	void expireMapTasks() noexcept;
+	//Refresh the membership of the multicast trees (routing may have changed)
+	void fixTrees() noexcept;
 	bool connectToRoute(unsigned long long id, Digest *hc) noexcept;
 	//=================================================================
 	/*
@@ -97,6 +120,14 @@ private:
 	void onRegistration(Watcher *w) noexcept;
 	//Called by (handleStop)
 	void onRecycle(Watcher *w) noexcept;
+	//Holds the <message> if its destination is a local client which is not connected
+	bool holdMessage(Message *message) noexcept;
+	//Delivers the messages held for the newly registered client <w>
+	void flushMailbox(Watcher *w) noexcept;
+	//Returns true if the <message> belongs to the overlay's control traffic
+	bool isControlMessage(const Message *message) noexcept;
+	//Sends the registration reply <message> ahead of the data if within budget
+	void prioritizeHandshake(Message *message) noexcept;
 	//Get the ID of the connection associated with the worker task (hub's ID if no worker)
 	unsigned long long getWorkerId() const noexcept;
 	//Check whether the ID belongs to the worker task's connection
@@ -120,6 +151,15 @@ private:
 	//Used by route and request handlers
 	int createRoute(Message *message) noexcept;
 	unsigned long long getNextHop(unsigned long long destination) const noexcept;
+	/*
+	 * Selects one of the parallel links to the overlay node <hop> for the flow
+	 * <source>-><destination>. Returns the identifier of the selected link.
+	 */
+	unsigned long long selectLink(unsigned long long hop,
+			unsigned long long source, unsigned long long destination) noexcept;
+	//Returns the least loaded active link to the overlay node <hop>
+	unsigned long long healthiestLink(unsigned long long hop,
+			unsigned long long flow) const noexcept;
 	bool allowCommunication(unsigned long long source,
 			unsigned long long destination) const noexcept;
 	//Process a command (called by OverlayHub::route)
@@ -136,6 +176,7 @@ private:
 	 */
 	int handleRegistrationRequest(Message *msg) noexcept;
 	int handleGetKeyRequest(Message *msg) noexcept;
+	int handleResumeRequest(Message *msg) noexcept;
 	int handleFindRootRequest(Message *msg) noexcept;
 	int handleBootstrapRequest(Message *msg) noexcept;
 	//-----------------------------------------------------------------
@@ -145,6 +186,64 @@ private:
 	int handlePublishRequest(Message *msg) noexcept;
 	int handleSubscribeRequest(Message *msg) noexcept;
 	int handleUnsubscribeRequest(Message *msg) noexcept;
+	//Returns true if the watcher <w> can subscribe to another topic
+	bool admitSubscription(const Watcher *w) const noexcept;
+	/*
+	 * Scribe-style multicast tree of the <topic>: the hubs having subscribers
+	 * join the tree rooted at the owner of the topic's key (see topicKey) via
+	 * their next hop. Joins or leaves the tree as required, the join request is
+	 * sent again if <refresh> is true. Returns true if this hub is on the tree.
+	 */
+	bool updateTree(unsigned int topic, bool refresh = false) noexcept;
+	//Membership of a multicast tree
+	struct Tree {
+		//The next hop towards the root
+		unsigned int parent;
+		//Has this hub joined the <parent>
+		bool joined;
+	};
+	//Same as above but works on an existing entry of the trees table
+	bool updateTree(unsigned int topic, Tree &tree, bool refresh) noexcept;
+	//Refresh all the trees (<parent> = 0) or the ones joined via the <parent>
+	struct TreeWalk {
+		OverlayHub *hub;
+		unsigned int parent;
+	};
+	//Trees table traversal callback, <arg> points to a TreeWalk
+	static int walkTree(unsigned int index, void *arg) noexcept;
+	//Ask the overlay node <id> to add (<join> = true) or remove this hub as a child
+	bool sendTreeRequest(unsigned int id, unsigned int topic, bool join) noexcept;
+	//Send a copy of the publication <msg> to the overlay node <id>
+	bool forwardPublication(const Message *msg, unsigned int id,
+			unsigned int hops) noexcept;
+	//Returns the DHT key of the <topic>'s rendezvous point
+	static unsigned int topicKey(unsigned int topic) noexcept;
+	/*
+	 * Returns the <topic> of a multicast request: carried in the session
+	 * field or in the first four bytes of the payload (extended qualifiers).
+	 */
+	static bool getTopic(const Message *msg, unsigned int &topic) noexcept;
+	//Tests the subscription <filter> on the application payload of the <msg>
+	static bool testFilter(const Message *msg,
+			const TopicFilter &filter) noexcept;
+	//Returns the application payload of a publication and its <length>
+	static const unsigned char* getPublication(const Message *msg,
+			unsigned int &length) noexcept;
+	/*
+	 * Replaces the publication queued up for the subscriber <w> having the same
+	 * conflation key as the <msg> if the subscriber has fallen behind. Returns
+	 * false if the <msg> must be queued up normally.
+	 */
+	bool conflate(Watcher *w, Message *msg, unsigned int topic,
+			const Conflation &conflation) noexcept;
+	//Conflation key of a publication
+	struct ConflationKey {
+		unsigned int topic;
+		uint64_t value;
+		const Conflation *conflation;
+	};
+	//Matches a queued publication against the ConflationKey <arg>
+	static bool matchPublication(const Message *queued, void *arg) noexcept;
 	//-----------------------------------------------------------------
 	/*
 	 * ROUTE MANAGEMENT
@@ -157,6 +256,9 @@ private:
 	int handleSetFingerRequest(Message *msg) noexcept;
 	int handleGetNeighboursRequest(Message *msg) noexcept;
 	int handleNotifyRequest(Message *msg) noexcept;
+	int handleGetShortcutRequest(Message *msg) noexcept;
+	int handleSetShortcutRequest(Message *msg) noexcept;
+	int handleGetLatencyRequest(Message *msg) noexcept;
 	//-----------------------------------------------------------------
 	/*
 	 * OVERLAY MANAGEMENT
@@ -164,14 +266,24 @@ private:
 	int handleFindSuccesssorRequest(Message *msg) noexcept;
 	int handlePingNodeRequest(Message *msg) noexcept;
 	int handleMapRequest(Message *msg) noexcept;
-	//0: continue; 1: success/discontinue; -1: error/discontinue
-	int mapFunction(Message *msg) noexcept;
+	int handleMapResponse(Message *msg) noexcept;
+	/*
+	 * Executes the map <function> on this hub and adds the results to the
+	 * <values> (MAP_VALUES elements). Partial results are reduced by summation,
+	 * hence a new function only needs to add it's own results here.
+	 * Returns false if the <function> is not supported.
+	 */
+	bool mapFunction(unsigned int function, uint64_t *values) noexcept;
+	//Returns the index of a free map task slot (MAP_TASKS if none available)
+	unsigned int createMapTask() noexcept;
+	//Forward the map task down the broadcast tree, returns the number of children
+	unsigned int forwardMapTask(unsigned int index) noexcept;
+	//Send the reduced result of the map task to it's parent and free the slot
+	void completeMapTask(unsigned int index) noexcept;
 	//-----------------------------------------------------------------
 	//Check the netmask if the request originated from a client
 	bool checkMask(unsigned long long source,
 			unsigned long long destination) const noexcept;
-	//Can the connection <uid> send privileged requests
-	bool isPrivileged(unsigned long long uid) const noexcept;
 	//Check the registration request
 	bool isValidRegistrationRequest(const Message *msg) noexcept;
 	//Check the registration request parameters
@@ -202,7 +314,29 @@ private:
 	static bool isExternalNode(unsigned long long uid) noexcept;
 	//Map an arbitrary 64-bit key to the dht key-space
 	static unsigned int mapKey(unsigned long long key) noexcept;
+	//-----------------------------------------------------------------
+	//Returns the identifier of the parallel link <index> of the overlay node <id>
+	static unsigned long long linkId(unsigned int id, unsigned int index,
+			bool inbound) noexcept;
+	//Returns true if <uid> belongs to a parallel link
+	static bool isLinkId(unsigned long long uid) noexcept;
+	//Returns true if <uid> belongs to a parallel link accepted by this hub
+	static bool isInboundLink(unsigned long long uid) noexcept;
+	//Returns the overlay node at the other end of the parallel link <uid>
+	static unsigned int linkOwner(unsigned long long uid) noexcept;
+	//Returns the index of the parallel link <uid>
+	static unsigned int linkIndex(unsigned long long uid) noexcept;
+public:
+	//Maximum number of parallel links per overlay neighbour
+	static constexpr unsigned int MAX_LINKS = 4;
 private:
+	/*
+	 * Identifiers of the additional links occupy the top of the active range:
+	 * [9223372036854767616-9223372036854775807]. The clients cannot register
+	 * these identifiers.
+	 */
+	static constexpr unsigned long long LINK_BASE = Socket::MAX_ACTIVE_ID + 1
+			- (2ULL * MAX_LINKS * MAX_NODES);
 	/**
 	 * For worker thread management
 	 */
@@ -237,6 +371,44 @@ private:
 		unsigned long long netMask;
 		//Group ID of the hub
 		unsigned int groupId;
+		//Maximum number of shortcut links
+		unsigned int shortcuts;
+		//Messages per decay period which make a destination hot
+		unsigned int shortcutThreshold;
+		//Decay period of the traffic counters in milliseconds
+		unsigned int shortcutDecay;
+		//Interval between the round trip time measurements in milliseconds
+		unsigned int pingInterval;
+		//Number of parallel links per finger (including the primary link)
+		unsigned int links;
+		//Maximum number of client flows pinned to the parallel links
+		unsigned int linkFlows;
+		//Default timeout of the map requests in milliseconds
+		unsigned int mapTimeout;
+		//Number of recent publications cached per topic
+		unsigned int lastValues;
+		//Maximum number of cached publications
+		unsigned int lastValuesLimit;
+		//Queued up messages which trigger the conflation of publications
+		unsigned int conflationBacklog;
+		//Maximum number of subscriptions per client (0 for no limit)
+		unsigned int subscriptions;
+		//Maximum number of subscriptions at this hub (0 for no limit)
+		unsigned int subscriptionsLimit;
+		//Number of messages held in memory for a disconnected client
+		unsigned int mailboxDepth;
+		//Maximum number of messages held in memory
+		unsigned int mailboxLimit;
+		//Time to live of the held messages in milliseconds
+		unsigned int mailboxTTL;
+		//Size of a mailbox's journal in bytes
+		unsigned int mailboxJournal;
+		//Directory for the mailbox journals
+		const char *mailboxPath;
+		//Time to live of the session resumption tokens in milliseconds
+		unsigned int resumptionTTL;
+		//Registration replies per second sent ahead of the data (0 to disable)
+		unsigned int handshakeRate;
 		//Bootstrap nodes
 		unsigned long long bootstrapNodes[128];
 	} ctx;
@@ -256,9 +428,93 @@ private:
 	 */
 	//For authentication of proxy connections, +1 for the controller
 	Digest sKeys[TABLESIZE + 1];
+	//For authentication of the shortcut connections
+	Digest scKeys[Shortcuts::SIZE];
+	//For authentication of the additional parallel links
+	Digest lKeys[TABLESIZE][MAX_LINKS - 1];
 	//For generation of message digests
 	Hash hashFn;
 	//-----------------------------------------------------------------
+	/**
+	 * Direct links to the roots of the heavily used keys
+	 */
+	Shortcuts shortcuts;
+	//Measures the decay period
+	Timer decayTimer;
+	//-----------------------------------------------------------------
+	/**
+	 * Round trip times of the overlay links (for proximity neighbour selection)
+	 */
+	struct {
+		//Smoothed round trip time in microseconds indexed by key (0: unknown)
+		unsigned int rtt[MAX_NODES];
+		//The node being probed (0 if none)
+		unsigned int probe;
+		//The probe which is to be replaced
+		unsigned int oldProbe;
+		//Number of maintenance rounds since the probe was set
+		unsigned int rounds;
+		//For authentication of the probe connection
+		Digest nonce;
+	} latency;
+	//Measures the ping interval
+	Timer pingTimer;
+	//Measures the link maintenance interval
+	Timer linkTimer;
+	//Links of the client flows
+	Flows flows;
+	//Measures the idle period of the flows
+	Timer flowTimer;
+	//Flows idle for this long (in milliseconds) are unpinned
+	static constexpr unsigned int FLOW_EXPIRY = 10000;
+	//Priority budget of the replies to the unauthenticated connections
+	TokenBucket handshakes;
+	//-----------------------------------------------------------------
+	/**
+	 * Map requests in progress (broadcast down the fingers, reduced on return)
+	 */
+	static constexpr unsigned int MAP_TASKS = 16;
+	static constexpr unsigned int MAP_VALUES = OverlayProtocol::MAP_VALUES;
+	struct {
+		//Identifies the task, zero (0) if the slot is free
+		uint32_t tag;
+		//The map function
+		uint32_t function;
+		//Time allowed for the subtree to respond in milliseconds
+		uint32_t timeout;
+		//Right boundary (exclusive) of the key range covered by this subtree
+		unsigned int limit;
+		//True if the request was inserted into the overlay at this hub
+		bool root;
+		//Next hop of the response (the parent hub or the requester's hop)
+		unsigned long long parent;
+		//The parent's tag, or the requester's ID if <root> is true
+		unsigned long long parentTag;
+		//For matching the response with the original request
+		uint16_t sequenceNumber;
+		uint8_t session;
+		//Number of children yet to respond
+		unsigned int pending;
+		//The partial result
+		uint64_t values[MAP_VALUES];
+		//Measures the timeout
+		Timer timer;
+	} mapTasks[MAP_TASKS];
+	//Number of active map tasks
+	unsigned int mapTaskCount;
+	//Source of the map task tags
+	uint32_t mapTag;
+	//-----------------------------------------------------------------
+	/**
+	 * Overlay-wide multicast trees (the children are subscribed as watchers)
+	 */
+	//Limit on the overlay hops of a publication (loop protection)
+	static constexpr unsigned int MAX_TREE_HOPS = 3 * TABLESIZE;
+	//Entries exist only for the topics having local subscribers or a parent
+	Khash<unsigned int, Tree> trees;
+	//Measures the tree refresh interval
+	Timer treeTimer;
+	//-----------------------------------------------------------------
 	/**
 	 * For cleaning up of the connections
 	 */
@@ -284,9 +540,22 @@ private:
 	} wd[8];
 	//-----------------------------------------------------------------
 	/**
-	 * For multicasting: 256 topics are available in total ranging between 0-255
+	 * For multicasting: 32-bit topic identifiers, topics 0-255 are also
+	 * available via the session field of the message header.
 	 */
 	Topics topics;
+	//The most recent publications for the late subscribers
+	LastValues lastValues;
+	//-----------------------------------------------------------------
+	/**
+	 * Store and forward of the messages to the disconnected clients
+	 */
+	Mailboxes mailboxes;
+	//-----------------------------------------------------------------
+	/**
+	 * Fast reconnection of the clients
+	 */
+	Resumption resumption;
 };
 
 } /* namespace wanhive */
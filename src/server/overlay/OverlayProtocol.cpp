@@ -400,6 +400,135 @@ bool OverlayProtocol::notifyRequest(uint64_t id, uint64_t predecessor) {
 			&& processNotifyResponse();
 }
 
+unsigned int OverlayProtocol::createGetShortcutRequest(uint64_t id,
+		uint32_t index) noexcept {
+	header().load(getSource(), id, (Message::HEADER_SIZE + sizeof(uint32_t)),
+			nextSequenceNumber(), getSession(), WH_DHT_CMD_NODE,
+			WH_DHT_QLF_GETSHORTCUT, WH_DHT_AQLF_REQUEST);
+	header().serialize(buffer());
+	Serializer::pack(payload(), "L", index);
+	return header().getLength();
+}
+
+unsigned int OverlayProtocol::processGetShortcutResponse(uint32_t index,
+		uint64_t &key) const noexcept {
+	if (!checkCommand(WH_DHT_CMD_NODE, WH_DHT_QLF_GETSHORTCUT)) {
+		return 0;
+	} else if (getHeader().getLength()
+			!= Message::HEADER_SIZE + sizeof(uint32_t) + sizeof(uint64_t)) {
+		return 0;
+	} else {
+		uint32_t v0 = index;
+		uint64_t v1 = 0;
+		Serializer::unpack(getPayload(), (char*) "LQ", &v0, &v1);
+		if (v0 == index) {
+			key = v1;
+			return getHeader().getLength();
+		} else {
+			key = 0;
+			return 0;
+		}
+	}
+}
+
+bool OverlayProtocol::getShortcutRequest(uint64_t id, uint32_t index,
+		uint64_t &key) {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=8, AQLF=0/1/127
+	 * BODY: 4 bytes in Request as <index>; 4 bytes as <index> + 8 bytes
+	 * as <key> in Response
+	 * TOTAL: 32+4=36 bytes in Request; 32+4+8=44 bytes in Response
+	 */
+	return createGetShortcutRequest(id, index) && executeRequest()
+			&& processGetShortcutResponse(index, key);
+}
+
+unsigned int OverlayProtocol::createSetShortcutRequest(uint64_t id,
+		uint32_t index, uint64_t key, uint64_t root) noexcept {
+	header().load(getSource(), id,
+			(Message::HEADER_SIZE + sizeof(uint32_t) + 2 * sizeof(uint64_t)),
+			nextSequenceNumber(), getSession(), WH_DHT_CMD_NODE,
+			WH_DHT_QLF_SETSHORTCUT, WH_DHT_AQLF_REQUEST);
+	header().serialize(buffer());
+	Serializer::pack(payload(), "LQQ", index, key, root);
+	return header().getLength();
+}
+
+unsigned int OverlayProtocol::processSetShortcutResponse(uint32_t index,
+		uint64_t key, uint64_t root) const noexcept {
+	if (!checkCommand(WH_DHT_CMD_NODE, WH_DHT_QLF_SETSHORTCUT)) {
+		return 0;
+	} else if (getHeader().getLength()
+			!= Message::HEADER_SIZE + sizeof(uint32_t) + 2 * sizeof(uint64_t)) {
+		return 0;
+	} else {
+		uint32_t v0 = index;
+		uint64_t v1 = key;
+		uint64_t v2 = root;
+		Serializer::unpack(getPayload(), (char*) "LQQ", &v0, &v1, &v2);
+		if (v0 == index && v1 == key && v2 == root) {
+			return getHeader().getLength();
+		} else {
+			return 0;
+		}
+	}
+}
+
+bool OverlayProtocol::setShortcutRequest(uint64_t id, uint32_t index,
+		uint64_t key, uint64_t root) {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=9, AQLF=0/1/127
+	 * BODY: 4 bytes as <index>, 8 bytes as <key> and 8 bytes as <root>
+	 * in Request and in Response
+	 * TOTAL: 32+4+8+8=52 bytes
+	 */
+	return createSetShortcutRequest(id, index, key, root) && executeRequest()
+			&& processSetShortcutResponse(index, key, root);
+}
+
+unsigned int OverlayProtocol::createGetLatencyRequest(uint64_t id,
+		uint64_t key) noexcept {
+	header().load(getSource(), id, (Message::HEADER_SIZE + sizeof(uint64_t)),
+			nextSequenceNumber(), getSession(), WH_DHT_CMD_NODE,
+			WH_DHT_QLF_GETLATENCY, WH_DHT_AQLF_REQUEST);
+	header().serialize(buffer());
+	Serializer::pack(payload(), "Q", key);
+	return header().getLength();
+}
+
+unsigned int OverlayProtocol::processGetLatencyResponse(uint64_t key,
+		uint32_t &rtt) const noexcept {
+	if (!checkCommand(WH_DHT_CMD_NODE, WH_DHT_QLF_GETLATENCY)) {
+		return 0;
+	} else if (getHeader().getLength()
+			!= Message::HEADER_SIZE + sizeof(uint64_t) + sizeof(uint32_t)) {
+		return 0;
+	} else {
+		uint64_t v0 = key;
+		uint32_t v1 = 0;
+		Serializer::unpack(getPayload(), (char*) "QL", &v0, &v1);
+		if (v0 == key) {
+			rtt = v1;
+			return getHeader().getLength();
+		} else {
+			rtt = 0;
+			return 0;
+		}
+	}
+}
+
+bool OverlayProtocol::getLatencyRequest(uint64_t id, uint64_t key,
+		uint32_t &rtt) {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=3, QLF=10, AQLF=0/1/127
+	 * BODY: 8 bytes as <key> in Request; 8 bytes as <key> + 4 bytes
+	 * as <round trip time> (microseconds) in Response
+	 * TOTAL: 32+8=40 bytes in Request; 32+8+4=44 bytes in Response
+	 */
+	return createGetLatencyRequest(id, key) && executeRequest()
+			&& processGetLatencyResponse(key, rtt);
+}
+
 unsigned int OverlayProtocol::createFindSuccessorRequest(uint64_t id,
 		uint64_t uid) noexcept {
 	header().load(getSource(), id, (Message::HEADER_SIZE + sizeof(uint64_t)),
@@ -467,29 +596,76 @@ bool OverlayProtocol::pingRequest(uint64_t id) {
 	return createPingRequest(id) && executeRequest() && processPingRequest();
 }
 
-unsigned int OverlayProtocol::createMapRequest(uint64_t id) noexcept {
-	header().load(getSource(), id, Message::HEADER_SIZE, nextSequenceNumber(),
+unsigned int OverlayProtocol::createPingRequest(uint64_t id,
+		uint64_t timestamp) noexcept {
+	/*
+	 * HEADER: SRC=0, DEST=X, ....CMD=4, QLF=1, AQLF=0/1/127
+	 * BODY: 8 bytes as <timestamp> in Request and Response (echoed back)
+	 * TOTAL: 32+8=40 bytes in Request and Response
+	 */
+	header().load(getSource(), id, (Message::HEADER_SIZE + sizeof(uint64_t)),
+			nextSequenceNumber(), getSession(), WH_DHT_CMD_OVERLAY,
+			WH_DHT_QLF_PING, WH_DHT_AQLF_REQUEST);
+	header().serialize(buffer());
+	Serializer::pack(payload(), "Q", timestamp);
+	return header().getLength();
+}
+
+unsigned int OverlayProtocol::processPingResponse(
+		uint64_t &timestamp) const noexcept {
+	if (!checkCommand(WH_DHT_CMD_OVERLAY, WH_DHT_QLF_PING,
+			WH_DHT_AQLF_ACCEPTED)) {
+		return 0;
+	} else if (getHeader().getLength()
+			!= Message::HEADER_SIZE + sizeof(uint64_t)) {
+		return 0;
+	} else {
+		timestamp = Serializer::unpacku64(getPayload());
+		return getHeader().getLength();
+	}
+}
+
+unsigned int OverlayProtocol::createMapRequest(uint64_t id, uint32_t function,
+		uint32_t timeout) noexcept {
+	header().load(getSource(), id,
+			Message::HEADER_SIZE + 2 * sizeof(uint32_t), nextSequenceNumber(),
 			getSession(), WH_DHT_CMD_OVERLAY, WH_DHT_QLF_MAP,
 			WH_DHT_AQLF_REQUEST);
 	header().serialize(buffer());
+	Serializer::pack(payload(), "LL", function, timeout);
 	return header().getLength();
 }
 
-unsigned int OverlayProtocol::processMapRequest() const noexcept {
+unsigned int OverlayProtocol::processMapResponse(uint32_t function,
+		uint64_t *values) const noexcept {
 	if (!checkCommand(WH_DHT_CMD_OVERLAY, WH_DHT_QLF_MAP)) {
 		return 0;
+	} else if (getHeader().getLength()
+			!= Message::HEADER_SIZE + sizeof(uint32_t)
+					+ MAP_VALUES * sizeof(uint64_t)) {
+		return 0;
+	} else if (Serializer::unpacku32(getPayload(0)) != function) {
+		return 0;
 	} else {
+		auto index = sizeof(uint32_t);
+		for (unsigned int i = 0; i < MAP_VALUES; i++) {
+			values[i] = Serializer::unpacku64(getPayload(index));
+			index += sizeof(uint64_t);
+		}
 		return getHeader().getLength();
 	}
 }
 
-bool OverlayProtocol::mapRequest(uint64_t id) {
+bool OverlayProtocol::mapRequest(uint64_t id, uint32_t function,
+		uint32_t timeout, uint64_t *values) {
 	/*
 	 * HEADER: SRC=0, DEST=X, ....CMD=4, QLF=2, AQLF=0/1/127
-	 * BODY: variable in Request; variable in Response
-	 * TOTAL: at least 32 bytes in Request and Response
+	 * BODY: 4 bytes as <function> + 4 bytes as <timeout> in Request;
+	 * 4 bytes as <function> + 8*MAP_VALUES bytes as <values> in Response
+	 * TOTAL: 32+4+4=40 bytes in Request; 32+4+64=100 bytes in Response
 	 */
-	return createMapRequest(id) && executeRequest() && processMapRequest();
+	return createMapRequest(id, function, timeout) && executeRequest()
+			&& processMapResponse(function, values);
 }
 
 } /* namespace wanhive */
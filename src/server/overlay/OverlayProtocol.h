@@ -70,6 +70,23 @@ public:
 	unsigned int processNotifyResponse() const noexcept;
 	bool notifyRequest(uint64_t id, uint64_t predecessor);
 
+	unsigned int createGetShortcutRequest(uint64_t id, uint32_t index) noexcept;
+	unsigned int processGetShortcutResponse(uint32_t index,
+			uint64_t &key) const noexcept;
+	bool getShortcutRequest(uint64_t id, uint32_t index, uint64_t &key);
+
+	unsigned int createSetShortcutRequest(uint64_t id, uint32_t index,
+			uint64_t key, uint64_t root) noexcept;
+	unsigned int processSetShortcutResponse(uint32_t index, uint64_t key,
+			uint64_t root) const noexcept;
+	bool setShortcutRequest(uint64_t id, uint32_t index, uint64_t key,
+			uint64_t root);
+
+	unsigned int createGetLatencyRequest(uint64_t id, uint64_t key) noexcept;
+	unsigned int processGetLatencyResponse(uint64_t key,
+			uint32_t &rtt) const noexcept;
+	bool getLatencyRequest(uint64_t id, uint64_t key, uint32_t &rtt);
+
 	unsigned int createFindSuccessorRequest(uint64_t id, uint64_t uid) noexcept;
 	unsigned int processFindSuccessorResponse(uint64_t uid,
 			uint64_t &key) const noexcept;
@@ -79,9 +96,30 @@ public:
 	unsigned int processPingRequest() const noexcept;
 	bool pingRequest(uint64_t id);
 
-	unsigned int createMapRequest(uint64_t id) noexcept;
-	unsigned int processMapRequest() const noexcept;
-	bool mapRequest(uint64_t id);
+	/*
+	 * Timestamped ping for measuring the round trip time without blocking on
+	 * the response: send the request and match the response by it's sequence
+	 * number. The <timestamp> is echoed back.
+	 */
+	unsigned int createPingRequest(uint64_t id, uint64_t timestamp) noexcept;
+	unsigned int processPingResponse(uint64_t &timestamp) const noexcept;
+
+	/*
+	 * Executes the map <function> on every hub of the overlay network and
+	 * returns the reduced (summed up) results in <values> which must hold
+	 * MAP_VALUES elements. <values>[0] is the number of hubs which responded,
+	 * <values>[1] is the number of subtrees which failed to respond within the
+	 * <timeout> (in milliseconds, 0 for the hub's default).
+	 */
+	unsigned int createMapRequest(uint64_t id, uint32_t function,
+			uint32_t timeout) noexcept;
+	unsigned int processMapResponse(uint32_t function,
+			uint64_t *values) const noexcept;
+	bool mapRequest(uint64_t id, uint32_t function, uint32_t timeout,
+			uint64_t *values);
+public:
+	//Number of values returned by the map request
+	static constexpr unsigned int MAP_VALUES = 8;
 };
 
 } /* namespace wanhive */
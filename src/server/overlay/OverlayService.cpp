@@ -12,6 +12,8 @@
 
 #include "OverlayService.h"
 #include "../../base/Logger.h"
+#include "../../base/Network.h"
+#include "../../base/Timer.h"
 #include "../../base/common/Exception.h"
 #include <cstring>
 
@@ -47,6 +49,10 @@ void OverlayService::setUpdateCycle(unsigned int updateCycle) noexcept {
 	ctx.updateCycle = updateCycle;
 }
 
+void OverlayService::setShortcutLimit(unsigned int shortcutLimit) noexcept {
+	ctx.shortcutLimit = shortcutLimit;
+}
+
 bool OverlayService::execute() {
 	try {
 		if (!initialized) {
@@ -75,7 +81,12 @@ bool OverlayService::execute() {
 			return false;
 		}
 
-		//STEP 5: success
+		//STEP 5: Resolve the shortcuts (failure is not fatal)
+		if (!fixShortcuts(uid)) {
+			WH_LOG_DEBUG("Shortcut resolution failed");
+		}
+
+		//STEP 6: success
 		delay = ctx.updateCycle;
 		return true;
 	} catch (const BaseException &e) {
@@ -222,7 +233,8 @@ bool OverlayService::fixFingerTable(uint64_t id) noexcept {
 			return false;
 		} else if (!findSuccessorRequest(target, start, key)) {
 			return false;
-		} else if (!setFingerRequest(id, fIndex, key)) {
+		} else if (!setFingerRequest(id, fIndex,
+				(fIndex ? selectFinger(id, fIndex, key) : key))) {
 			return false;
 		} else {
 			return true;
@@ -233,6 +245,65 @@ bool OverlayService::fixFingerTable(uint64_t id) noexcept {
 	}
 }
 
+uint64_t OverlayService::selectFinger(uint64_t id, unsigned int index,
+		uint64_t key) noexcept {
+	try {
+		//Valid interval: [id + 2^index, id + 2^(index+1))
+		unsigned int start = Node::successor(id, index);
+		unsigned int end = (Node::successor(id, index + 1) - 1) & Node::MAX_ID;
+		if (!Node::isInRange(key, start, end)) {
+			return key;
+		}
+		//-----------------------------------------------------------------
+		//Unmeasured candidates get measured by the node in the background
+		uint64_t best = key;
+		uint32_t bestRtt = 0;
+		getLatencyRequest(id, key, bestRtt);
+
+		auto candidate = key;
+		for (unsigned int i = 1; i < FINGER_CANDIDATES; ++i) {
+			uint64_t next = 0;
+			uint32_t rtt = 0;
+			if (!getSuccessorRequest(candidate, next) || next == id
+					|| !Node::isInRange(next, start, end)) {
+				break;
+			} else if (getLatencyRequest(id, next, rtt)
+					&& (!bestRtt || rtt < bestRtt)) {
+				best = next;
+				bestRtt = rtt;
+			}
+			candidate = next;
+		}
+		return best;
+	} catch (const BaseException &e) {
+		//Fall back to the identifier based selection
+		return key;
+	}
+}
+
+bool OverlayService::fixShortcuts(uint64_t id) noexcept {
+	try {
+		for (unsigned int i = 0; i < ctx.shortcutLimit; ++i) {
+			uint64_t key = 0;
+			uint64_t root = 0;
+			if (!getShortcutRequest(id, i, key)) {
+				//Empty slot
+				continue;
+			} else if (!findSuccessorRequest(id, key, root) || root == id) {
+				//Unresolved, or the key belongs to this node
+				continue;
+			} else {
+				//Fails if the slot was recycled in the meantime
+				setShortcutRequest(id, i, key, root);
+			}
+		}
+		return true;
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+		return false;
+	}
+}
+
 bool OverlayService::fixSuccessorsList(uint64_t id) noexcept {
 	try {
 		if (SUCCESSOR_LIST_LEN > 1) {
@@ -289,6 +360,74 @@ bool OverlayService::checkController(uint64_t id) {
 	}
 }
 
+void OverlayService::rankBootstrapNodes() noexcept {
+	unsigned int rtt[WH_ARRAYLEN(ctx.nodes)];
+	uint16_t sequence[WH_ARRAYLEN(ctx.nodes)];
+	unsigned int count = 0;
+	//Try self and the unresponsive nodes at the end
+	for (; ctx.nodes[count]; ++count) {
+		rtt[count] = 0xffffffff;
+		sequence[count] = 0;
+	}
+
+	try {
+		//Probe all the nodes at once, a dead node doesn't hold up the rest
+		unsigned int pending = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			if (ctx.nodes[i] != uid
+					&& createPingRequest(ctx.nodes[i], Timer::timeStamp())) {
+				send();
+				sequence[i] = getHeader().getSequenceNumber();
+				++pending;
+			}
+		}
+
+		//Collect the responses, the late ones are skipped by the next requests
+		Timer timer;
+		while (pending) {
+			auto waited = (unsigned int) (timer.elapsed() * 1000);
+			if (waited >= PROBE_TIMEOUT
+					|| !Network::waitForInput(getSocket(),
+							PROBE_TIMEOUT - waited)) {
+				break;
+			}
+
+			receive();
+			for (unsigned int i = 0; i < count; ++i) {
+				if (!sequence[i]
+						|| sequence[i] != getHeader().getSequenceNumber()) {
+					continue;
+				}
+
+				uint64_t timestamp = 0;
+				auto now = Timer::timeStamp();
+				if (processPingResponse(timestamp) && now >= timestamp
+						&& (now - timestamp) < 0xffffffffULL) {
+					rtt[i] = (unsigned int) (now - timestamp);
+				}
+				sequence[i] = 0;
+				--pending;
+				break;
+			}
+		}
+	} catch (const BaseException &e) {
+		WH_LOG_EXCEPTION(e);
+	}
+
+	//Insertion sort, the list is short and nearly sorted
+	for (unsigned int i = 1; i < count; ++i) {
+		auto node = ctx.nodes[i];
+		auto value = rtt[i];
+		auto j = i;
+		for (; j > 0 && rtt[j - 1] > value; --j) {
+			ctx.nodes[j] = ctx.nodes[j - 1];
+			rtt[j] = rtt[j - 1];
+		}
+		ctx.nodes[j] = node;
+		rtt[j] = value;
+	}
+}
+
 void OverlayService::setup() {
 	try {
 		if (!uid || initialized) {
@@ -327,8 +466,9 @@ void OverlayService::setup() {
 		}
 		//-----------------------------------------------------------------
 		/*
-		 * Join using a predefined list of bootstrap nodes
+		 * Join using a predefined list of bootstrap nodes, fastest first
 		 */
+		rankBootstrapNodes();
 		auto joinSelf = false;
 		auto nodes = ctx.nodes;
 
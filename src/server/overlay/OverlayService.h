@@ -33,6 +33,7 @@ public:
 	void setConnection(int connection) noexcept;
 	void setRetryInterval(unsigned int retryInterval) noexcept;
 	void setUpdateCycle(unsigned int updateCycle) noexcept;
+	void setShortcutLimit(unsigned int shortcutLimit) noexcept;
 	//-----------------------------------------------------------------
 	/*
 	 * Execute this periodically to keep the network stable.
@@ -67,6 +68,15 @@ private:
 	bool stabilize(uint64_t id);
 	//Fix the finger table for the node identified by <id>
 	bool fixFingerTable(uint64_t id) noexcept;
+	/*
+	 * Proximity neighbour selection: returns the node with the lowest round
+	 * trip time (as measured by the node <id>) among <key> and it's successors
+	 * which are valid candidates for the finger at the given <index>.
+	 */
+	uint64_t selectFinger(uint64_t id, unsigned int index,
+			uint64_t key) noexcept;
+	//Resolve the roots of the hot keys recorded by the node identified by <id>
+	bool fixShortcuts(uint64_t id) noexcept;
 	//-----------------------------------------------------------------
 	/**
 	 * Following two functions are called by <stabilize>
@@ -78,6 +88,11 @@ private:
 	//Check the connection with the controller
 	bool checkController(uint64_t id);
 	//-----------------------------------------------------------------
+	/*
+	 * Sorts the bootstrap nodes in the increasing order of response time. The
+	 * nodes are pinged in parallel and waited upon for at most PROBE_TIMEOUT.
+	 */
+	void rankBootstrapNodes() noexcept;
 	//Sets things up
 	void setup();
 	//Cleans up the internal structures
@@ -104,6 +119,10 @@ private:
 	 */
 	static constexpr unsigned int SUCCESSOR_LIST_LEN = (
 			Node::KEYLENGTH > 1 ? Node::KEYLENGTH - 1 : 1);
+	//Number of candidates considered during the finger selection
+	static constexpr unsigned int FINGER_CANDIDATES = 4;
+	//Milliseconds to wait for the bootstrap nodes' ping responses
+	static constexpr unsigned int PROBE_TIMEOUT = 500;
 	//The backup successors list, excluding the immediate successor
 	uint64_t successors[SUCCESSOR_LIST_LEN];
 	//-----------------------------------------------------------------
@@ -120,6 +139,8 @@ private:
 		unsigned int retryInterval;
 		//Wait period between routing table updates
 		unsigned int updateCycle;
+		//Number of shortcut slots to resolve
+		unsigned int shortcutLimit;
 	} ctx;
 };
 
@@ -473,17 +473,12 @@ void OverlayTool::publishCmd() {
 	uint64_t id = destinationId;
 
 	unsigned int topic = 0;
-	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_ID << "]: ";
+	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_XID << "]: ";
 	std::cin >> topic;
 	if (CommandLine::inputError()) {
 		return;
 	}
 
-	if (topic > Topic::MAX_ID) {
-		std::cout << "Invalid topic" << std::endl;
-		return;
-	}
-
 	char s[128];
 	std::cout << "Message (max 100 characters): ";
 	std::cin.ignore();
@@ -508,19 +503,65 @@ void OverlayTool::subscribeCmd() {
 	std::cout << "CMD: [SUBSCRIBE]" << std::endl;
 	uint64_t id = destinationId;
 	unsigned int topic = 0;
-	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_ID << "]: ";
+	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_XID << "]: ";
 	std::cin >> topic;
 	if (CommandLine::inputError()) {
 		return;
 	}
 
-	if (topic > Topic::MAX_ID) {
-		std::cout << "Invalid topic" << std::endl;
+	unsigned int op = 0;
+	std::cout << "Filter [0: NONE, 2: EQ, 3: NE, 4: LT, 5: LE, 6: GT, 7: GE]: ";
+	std::cin >> op;
+	if (CommandLine::inputError()) {
+		return;
+	}
+
+	TopicFilter filter;
+	filter.clear();
+	if (op) {
+		unsigned int offset = 0;
+		unsigned int width = 0;
+		uint64_t value = 0;
+		std::cout << "Payload offset, width [1, 2, 4, 8] and value: ";
+		std::cin >> offset >> width >> value;
+		if (CommandLine::inputError()) {
+			return;
+		}
+
+		if (!filter.setCompare((TopicFilter::Operator) op, offset, width,
+				value)) {
+			std::cout << "Invalid filter" << std::endl;
+			return;
+		}
+	}
+
+	int width = -1;
+	std::cout << "Conflation key width [-1: disabled, 0: topic only, 1-8]: ";
+	std::cin >> width;
+	if (CommandLine::inputError()) {
 		return;
 	}
 
+	Conflation conflation;
+	conflation.clear();
+	if (width >= 0) {
+		unsigned int offset = 0;
+		if (width) {
+			std::cout << "Conflation key offset: ";
+			std::cin >> offset;
+			if (CommandLine::inputError()) {
+				return;
+			}
+		}
+
+		if (!conflation.set(offset, width)) {
+			std::cout << "Invalid conflation key" << std::endl;
+			return;
+		}
+	}
+
 	try {
-		if (subscribeRequest(id, topic)) {
+		if (subscribeRequest(id, topic, &filter, &conflation)) {
 			std::cout << "SUBSCRIBE SUCCEEDED" << std::endl;
 		} else {
 			std::cout << "SUBSCRIBE FAILED" << std::endl;
@@ -535,17 +576,12 @@ void OverlayTool::unsubscribeCmd() {
 	std::cout << "CMD: [UNSUBSCRIBE]" << std::endl;
 	uint64_t id = destinationId;
 	unsigned int topic = 0;
-	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_ID << "]: ";
+	std::cout << "Topic [" << Topic::MIN_ID << "-" << Topic::MAX_XID << "]: ";
 	std::cin >> topic;
 	if (CommandLine::inputError()) {
 		return;
 	}
 
-	if (topic > Topic::MAX_ID) {
-		std::cout << "Invalid topic" << std::endl;
-		return;
-	}
-
 	try {
 		if (unsubscribeRequest(id, topic)) {
 			std::cout << "UNSUBSCRIBE SUCCEEDED" << std::endl;
@@ -772,9 +808,32 @@ void OverlayTool::pingCmd() {
 void OverlayTool::mapCmd() {
 	std::cout << "CMD: [MAP]" << std::endl;
 	uint64_t id = destinationId;
+	uint32_t function = 0;
+	uint32_t timeout = 0;
+	std::cout << "Function [0: NULL, 1: STATISTICS]: ";
+	std::cin >> function;
+	if (CommandLine::inputError()) {
+		return;
+	}
+
+	std::cout << "Timeout (ms, 0 for default): ";
+	std::cin >> timeout;
+	if (CommandLine::inputError()) {
+		return;
+	}
+
 	try {
-		if (mapRequest(id)) {
-			std::cout << "MAP SUCCEEDED" << std::endl;
+		uint64_t values[MAP_VALUES];
+		if (mapRequest(id, function, timeout, values)) {
+			std::cout << "MAP SUCCEEDED, HUBS: " << values[0]
+					<< ", MISSING SUBTREES: " << values[1] << std::endl;
+			if (function == WH_DHT_MAP_STATISTICS) {
+				std::cout << "CONNECTIONS: " << values[2] << ", MESSAGES: "
+						<< values[3] << "\nRECEIVED: " << values[4]
+						<< " PACKETS, " << values[5] << " BYTES\nDROPPED: "
+						<< values[6] << " PACKETS, " << values[7] << " BYTES"
+						<< std::endl;
+			}
 		} else {
 			std::cout << "MAP FAILED" << std::endl;
 		}
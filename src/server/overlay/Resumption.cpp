@@ -0,0 +1,112 @@
+/*
+ * Resumption.cpp
+ *
+ * Session resumption tokens
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Resumption.h"
+#include "../../base/ds/Serializer.h"
+#include "../../base/ds/Twiddler.h"
+#include <cstring>
+#include <ctime>
+
+namespace wanhive {
+
+Resumption::Resumption() noexcept :
+		ttl(0), watermark(64) {
+
+}
+
+Resumption::~Resumption() {
+
+}
+
+void Resumption::setTTL(unsigned int ttl) noexcept {
+	this->ttl = ttl;
+}
+
+unsigned int Resumption::getTTL() const noexcept {
+	return ttl;
+}
+
+bool Resumption::issue(unsigned long long uid, unsigned char group,
+		const Digest *secret, const PKI *pki, Message *msg) noexcept {
+	if (!ttl || !secret || !pki || !pki->hasHostKey() || !msg) {
+		return false;
+	}
+
+	unsigned char token[SIZE];
+	Serializer::packi64(token, uid);
+	Serializer::packi8(token + 8, group);
+	Serializer::packi64(token + 9, now() + ttl);
+	hashFn.create(secret, Hash::SIZE, (Digest*) (token + 17));
+	return pki->sign(token, CLAIMS_SIZE, (Signature*) (token + CLAIMS_SIZE))
+			&& msg->appendBytes(token, SIZE);
+}
+
+bool Resumption::redeem(const Message *msg, const Digest *secret,
+		const PKI *pki, unsigned long long &uid, unsigned char &group) noexcept {
+	if (!ttl || !secret || !pki || !msg || msg->getPayloadLength() < SIZE) {
+		return false;
+	}
+
+	auto token = msg->getBytes(0);
+	auto expiration = Serializer::unpacku64(token + 9);
+	auto current = now();
+	Digest binding;
+	hashFn.create(secret, Hash::SIZE, &binding);
+	if (expiration <= current || expiration > (current + ttl)) {
+		//Expired, or issued with a longer TTL
+		return false;
+	} else if (memcmp(binding, token + 17, Hash::SIZE)) {
+		//Not bound to this secret
+		return false;
+	} else if (!pki->verify(token, CLAIMS_SIZE,
+			(const Signature*) (token + CLAIMS_SIZE))) {
+		return false;
+	}
+
+	if (redeemed.size() >= watermark) {
+		expire(current);
+		watermark = 2 * redeemed.size() + 64;
+	}
+
+	if (redeemed.hmPut(Twiddler::FVN1aHash(token, SIZE), expiration)) {
+		uid = Serializer::unpacku64(token);
+		group = Serializer::unpacku8(token + 8);
+		return true;
+	} else {
+		//Replayed
+		return false;
+	}
+}
+
+void Resumption::clear() noexcept {
+	redeemed.clear();
+	watermark = 64;
+}
+
+void Resumption::expire(unsigned long long now) noexcept {
+	Expiry expiry { this, now };
+	redeemed.iterate(removeExpired, &expiry);
+}
+
+int Resumption::removeExpired(unsigned int index, void *arg) noexcept {
+	auto expiry = static_cast<Expiry*>(arg);
+	auto expiration = expiry->resumption->redeemed.getValueReference(index);
+	return (*expiration <= expiry->now) ? 1 : 0;
+}
+
+unsigned long long Resumption::now() noexcept {
+	timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (((unsigned long long) ts.tv_sec * 1000) + (ts.tv_nsec / 1000000));
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,83 @@
+/*
+ * Resumption.h
+ *
+ * Session resumption tokens
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_OVERLAY_RESUMPTION_H_
+#define WH_SERVER_OVERLAY_RESUMPTION_H_
+#include "../../base/ds/Khash.h"
+#include "../../util/Hash.h"
+#include "../../util/Message.h"
+#include "../../util/PKI.h"
+
+namespace wanhive {
+/**
+ * Short lived, signed tokens which allow a registered client to reconnect
+ * and restore its registration without the authentication and bootstrap.
+ * A token carries the client's identity, group, expiration time (wall clock)
+ * and the digest of a secret known only to the client. It is signed with the
+ * hub's private key, hence any hub sharing the key pair can redeem it,
+ * including after restart. The token alone is not a credential: the client
+ * must also prove the knowledge of the secret over a nonce bound to the
+ * connection, similar to the registration.
+ * A token can be redeemed only once at a given hub.
+ * Token: [IDENTITY: 8][GROUP: 1][EXPIRATION: 8][BINDING: 64][SIGNATURE]
+ * Thread safe at class level
+ */
+class Resumption {
+public:
+	Resumption() noexcept;
+	~Resumption();
+	//-----------------------------------------------------------------
+	//Tokens expire after <ttl> milliseconds, 0 disables the tokens
+	void setTTL(unsigned int ttl) noexcept;
+	//Returns the tokens' TTL in milliseconds
+	unsigned int getTTL() const noexcept;
+	//-----------------------------------------------------------------
+	//Appends a new token bound to the client's <secret> to the payload of <msg>
+	bool issue(unsigned long long uid, unsigned char group,
+			const Digest *secret, const PKI *pki, Message *msg) noexcept;
+	/*
+	 * Verifies and consumes the token carried at the start of the payload of
+	 * <msg> if it is bound to the <secret>, returns the client's <uid> and
+	 * <group> on success.
+	 */
+	bool redeem(const Message *msg, const Digest *secret, const PKI *pki,
+			unsigned long long &uid, unsigned char &group) noexcept;
+	//Forgets the redeemed tokens
+	void clear() noexcept;
+private:
+	void expire(unsigned long long now) noexcept;
+	static int removeExpired(unsigned int index, void *arg) noexcept;
+	//Returns the wall clock time in milliseconds
+	static unsigned long long now() noexcept;
+public:
+	//Size of the claims (identity, group, expiration, and binding)
+	static constexpr unsigned int CLAIMS_SIZE = 17 + Hash::SIZE;
+	//Size of a token in bytes
+	static constexpr unsigned int SIZE = CLAIMS_SIZE + PKI::SIGNATURE_LENGTH;
+private:
+	//Argument of the expiry callback
+	struct Expiry {
+		Resumption *resumption;
+		unsigned long long now;
+	};
+
+	//Digests of the redeemed tokens mapped to their expiration times
+	Khash<unsigned long long, unsigned long long> redeemed;
+	Hash hashFn;
+	unsigned int ttl;
+	//Expire the redeemed tokens after the table grows this big
+	unsigned int watermark;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_OVERLAY_RESUMPTION_H_ */
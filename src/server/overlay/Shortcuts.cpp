@@ -0,0 +1,222 @@
+/*
+ * Shortcuts.cpp
+ *
+ * Traffic-adaptive shortcut links
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#include "Shortcuts.h"
+#include "../../base/ds/Twiddler.h"
+#include <cstring>
+
+namespace wanhive {
+
+Shortcuts::Shortcuts() noexcept {
+	clear();
+	limit = 0;
+	threshold = 1;
+}
+
+Shortcuts::~Shortcuts() {
+
+}
+
+void Shortcuts::setLimit(unsigned int limit) noexcept {
+	this->limit = Twiddler::min(limit, SIZE);
+}
+
+unsigned int Shortcuts::getLimit() const noexcept {
+	return limit;
+}
+
+void Shortcuts::setThreshold(unsigned int threshold) noexcept {
+	this->threshold = threshold ? threshold : 1;
+}
+
+void Shortcuts::record(unsigned int key) noexcept {
+	if (!limit || key == NO_KEY) {
+		return;
+	}
+	//-----------------------------------------------------------------
+	//Update the sketch and estimate the volume (saturating counters)
+	uint32_t estimate = 0xffffffff;
+	for (unsigned int i = 0; i < DEPTH; ++i) {
+		auto &c = sketch[i][locate(key, i)];
+		c += (c != 0xffffffff);
+		estimate = Twiddler::min(estimate, c);
+	}
+	//-----------------------------------------------------------------
+	//Track the heavy hitters (prefer an empty slot, else the coldest one)
+	unsigned int victim = SIZE;
+	for (unsigned int i = 0; i < limit; ++i) {
+		if (slots[i].key == key) {
+			slots[i].count = estimate;
+			return;
+		} else if (slots[i].key == NO_KEY) {
+			victim = (victim == SIZE || slots[victim].key != NO_KEY) ?
+					i : victim;
+		} else if (victim == SIZE
+				|| (slots[victim].key != NO_KEY
+						&& slots[i].count < slots[victim].count)) {
+			victim = i;
+		}
+	}
+
+	if (victim == SIZE || estimate < threshold) {
+		return;
+	} else if (slots[victim].key == NO_KEY
+			|| slots[victim].count < estimate) {
+		release(victim);
+		slots[victim].key = key;
+		slots[victim].count = estimate;
+	}
+}
+
+void Shortcuts::decay() noexcept {
+	for (unsigned int i = 0; i < DEPTH; ++i) {
+		for (unsigned int j = 0; j < WIDTH; ++j) {
+			sketch[i][j] >>= 1;
+		}
+	}
+
+	for (unsigned int i = 0; i < SIZE; ++i) {
+		if (slots[i].key == NO_KEY) {
+			continue;
+		} else if (i >= limit || slots[i].count < threshold) {
+			//Turned cold
+			release(i);
+		} else {
+			slots[i].count >>= 1;
+		}
+	}
+}
+
+bool Shortcuts::getKey(unsigned int index, unsigned int &key) const noexcept {
+	if (index < limit && slots[index].key != NO_KEY) {
+		key = slots[index].key;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+unsigned int Shortcuts::get(unsigned int index) const noexcept {
+	if (index < SIZE) {
+		return slots[index].id;
+	} else {
+		return 0;
+	}
+}
+
+bool Shortcuts::set(unsigned int index, unsigned int key,
+		unsigned int id) noexcept {
+	if (index < limit && key != NO_KEY && slots[index].key == key) {
+		if (slots[index].id != id) {
+			slots[index].id = id;
+			slots[index].connected = false;
+		}
+		//Ask for maintenance
+		stable = false;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+bool Shortcuts::isConsistent(unsigned int index) const noexcept {
+	if (index < SIZE) {
+		return slots[index].id == slots[index].oldId;
+	} else {
+		return false;
+	}
+}
+
+unsigned int Shortcuts::makeConsistent(unsigned int index) noexcept {
+	unsigned int oldId = 0;
+	if (index < SIZE) {
+		oldId = slots[index].oldId;
+		slots[index].oldId = slots[index].id;
+	}
+	return oldId;
+}
+
+bool Shortcuts::isConnected(unsigned int index) const noexcept {
+	if (index < SIZE) {
+		return slots[index].connected;
+	} else {
+		return false;
+	}
+}
+
+void Shortcuts::setConnected(unsigned int index, bool status) noexcept {
+	if (index < SIZE) {
+		slots[index].connected = status;
+	}
+}
+
+void Shortcuts::update(unsigned int id, bool joined) noexcept {
+	for (unsigned int i = 0; i < SIZE; ++i) {
+		if (slots[i].id && slots[i].id == id) {
+			slots[i].connected = joined;
+		}
+	}
+}
+
+bool Shortcuts::contains(unsigned int id) const noexcept {
+	for (unsigned int i = 0; i < SIZE; ++i) {
+		if (slots[i].id && slots[i].id == id) {
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int Shortcuts::nextHop(unsigned int key) const noexcept {
+	for (unsigned int i = 0; i < limit; ++i) {
+		if (slots[i].key == key && slots[i].connected) {
+			return slots[i].id;
+		}
+	}
+	return 0;
+}
+
+bool Shortcuts::isStable() const noexcept {
+	return stable;
+}
+
+void Shortcuts::setStable(bool stable) noexcept {
+	this->stable = stable;
+}
+
+void Shortcuts::clear() noexcept {
+	memset(sketch, 0, sizeof(sketch));
+	for (unsigned int i = 0; i < SIZE; ++i) {
+		slots[i].key = NO_KEY;
+		slots[i].count = 0;
+		slots[i].id = 0;
+		slots[i].oldId = 0;
+		slots[i].connected = false;
+	}
+	stable = true;
+}
+
+unsigned int Shortcuts::locate(unsigned int key, unsigned int row) noexcept {
+	auto h = Twiddler::mix((((unsigned long long) row) << 32) | key);
+	return (unsigned int) (h & (WIDTH - 1));
+}
+
+void Shortcuts::release(unsigned int index) noexcept {
+	slots[index].key = NO_KEY;
+	slots[index].count = 0;
+	slots[index].id = 0;
+	slots[index].connected = false;
+	//Tear down the old link during the maintenance
+	stable = stable && (slots[index].oldId == 0);
+}
+
+} /* namespace wanhive */
@@ -0,0 +1,110 @@
+/*
+ * Shortcuts.h
+ *
+ * Traffic-adaptive shortcut links
+ *
+ *
+ * Copyright (C) 2020 Wanhive Systems Private Limited (info@wanhive.com)
+ * This program is part of the Wanhive IoT Platform.
+ * Check the COPYING file for the license.
+ *
+ */
+
+#ifndef WH_SERVER_OVERLAY_SHORTCUTS_H_
+#define WH_SERVER_OVERLAY_SHORTCUTS_H_
+#include <cstdint>
+
+namespace wanhive {
+/**
+ * Tracks the forwarded traffic per DHT key and maintains a small table of
+ * direct links to the roots of the heaviest keys (heavy hitters).
+ * Traffic volume is estimated using a count-min sketch, counters decay
+ * exponentially with every call to <decay>.
+ * Keys passed to the functions must remain within the DHT key space.
+ * Thread safe at class level
+ */
+class Shortcuts {
+public:
+	Shortcuts() noexcept;
+	~Shortcuts();
+	//-----------------------------------------------------------------
+	/**
+	 * Settings
+	 */
+	//Use at most <limit> slots (capped at SIZE), zero (0) disables the shortcuts
+	void setLimit(unsigned int limit) noexcept;
+	//Returns the number of usable slots
+	unsigned int getLimit() const noexcept;
+	//A key becomes hot after receiving at least <threshold> messages per decay period
+	void setThreshold(unsigned int threshold) noexcept;
+	//-----------------------------------------------------------------
+	/**
+	 * Traffic accounting
+	 */
+	//Records a message forwarded towards the <key>
+	void record(unsigned int key) noexcept;
+	//Halves all the counters, slots which have turned cold are released
+	void decay() noexcept;
+	//-----------------------------------------------------------------
+	/**
+	 * Slot management (similar to the fingers of the routing table)
+	 */
+	//Returns the hot key at the given <index> in <key>, false if the slot is empty
+	bool getKey(unsigned int index, unsigned int &key) const noexcept;
+	//Returns the root of the hot key at the given <index> (0 if unresolved)
+	unsigned int get(unsigned int index) const noexcept;
+	//Sets the root <id> of the <key> at the given <index>, fails if the key has changed
+	bool set(unsigned int index, unsigned int key, unsigned int id) noexcept;
+	//Has the new root at the given <index> been committed
+	bool isConsistent(unsigned int index) const noexcept;
+	//Commits the new root at the given <index> and returns the old root
+	unsigned int makeConsistent(unsigned int index) noexcept;
+	//Is the slot at the given <index> in connected state
+	bool isConnected(unsigned int index) const noexcept;
+	//Updates the connected <status> of the slot at the given <index>
+	void setConnected(unsigned int index, bool status) noexcept;
+	//Node <id> has either joined or left the network, update the slots
+	void update(unsigned int id, bool joined) noexcept;
+	//Returns true if <id> is the root of any of the hot keys
+	bool contains(unsigned int id) const noexcept;
+	//Returns the root of the <key> if a connected shortcut exists, 0 otherwise
+	unsigned int nextHop(unsigned int key) const noexcept;
+
+	//Were the slots updated since the last maintenance
+	bool isStable() const noexcept;
+	//Set the slots' <stable> state
+	void setStable(bool stable) noexcept;
+	//Resets the traffic counters and the slots
+	void clear() noexcept;
+private:
+	//Returns the index of the counter for the <key> in the given <row>
+	static unsigned int locate(unsigned int key, unsigned int row) noexcept;
+	//Releases the slot (the old root is retained for the clean up)
+	void release(unsigned int index) noexcept;
+public:
+	//Maximum number of shortcuts
+	static constexpr unsigned int SIZE = 8;
+private:
+	//Dimensions of the count-min sketch (WIDTH must be a power of 2)
+	static constexpr unsigned int DEPTH = 4;
+	static constexpr unsigned int WIDTH = 256;
+	static constexpr unsigned int NO_KEY = 0xffffffff;
+
+	struct Slot {
+		unsigned int key;
+		unsigned int count;
+		unsigned int id;
+		unsigned int oldId;
+		bool connected;
+	};
+
+	uint32_t sketch[DEPTH][WIDTH];
+	Slot slots[SIZE];
+	unsigned int limit;
+	unsigned int threshold;
+	bool stable;
+};
+
+} /* namespace wanhive */
+
+#endif /* WH_SERVER_OVERLAY_SHORTCUTS_H_ */
@@ -11,6 +11,7 @@
  */
 
 #include "Topics.h"
+#include <new>
 
 namespace wanhive {
 
@@ -19,110 +20,214 @@ Topics::Topics() noexcept {
 }
 
 Topics::~Topics() {
-
+	clear();
 }
 
-bool Topics::put(unsigned int topic, const Watcher *w) noexcept {
-	if ((topic < Topic::COUNT) && w) {
-		int ret = 0;
-		unsigned int i = indexes.put( { w, topic }, ret);
-		if (ret) { //Key was not present
-			//Elements are always added at the end of the array
-			unsigned int index = topics[topic].readSpace();
-			if (indexes.setValue(i, index)) {
-				topics[topic].put(w);
-				return true;
-			} else {
-				indexes.remove(i);
-				return false;
-			}
-		} else { //Key already present
-			return true;
+bool Topics::put(unsigned int topic, Watcher *w, const TopicFilter *filter,
+		const Conflation *conflation) noexcept {
+	Subscriber sub;
+	sub.w = w;
+	if (filter) {
+		sub.filter = *filter;
+	} else {
+		sub.filter.clear();
+	}
+
+	if (conflation) {
+		sub.conflation = *conflation;
+	} else {
+		sub.conflation.clear();
+	}
+
+	Position *p = nullptr;
+	if (!w) {
+		return false;
+	} else if ((p = getPosition(topic, w))) {
+		//Update the settings
+		auto ws = getSubscribers(topic, false);
+		auto entry = ws ? ws->get(p->subscriber) : nullptr;
+		if (entry) {
+			entry->filter = sub.filter;
+			entry->conflation = sub.conflation;
 		}
+		return true;
+	}
+
+	auto ws = getSubscribers(topic, true);
+	auto ts = getSubscriptions(w, true);
+	//Elements are always added at the end of the arrays
+	if (ws && ts
+			&& indexes.hmPut( { w, topic },
+					{ ws->readSpace(), ts->readSpace() })) {
+		ws->put(sub);
+		ts->put(topic);
+		return true;
 	} else {
+		release(topic, w);
 		return false;
 	}
 }
 
-Watcher* Topics::get(unsigned int topic, unsigned int index) const noexcept {
-	if (topic < Topic::COUNT) {
-		const Watcher *w = nullptr;
-		if (topics[topic].get(w, index)) {
-			return const_cast<Watcher*>(w);
-		} else {
-			return nullptr;
-		}
+const Topics::Subscriber* Topics::get(unsigned int topic,
+		unsigned int index) const noexcept {
+	Array<Subscriber> *ws = nullptr;
+	if (subscribers.hmGet(topic, ws)) {
+		return ws->get(index);
 	} else {
 		return nullptr;
 	}
 }
 
 void Topics::remove(unsigned int topic, const Watcher *w) noexcept {
-	if ((topic < Topic::COUNT) && w) {
-		//Get the iterator to the key
-		unsigned int i = indexes.get( { w, topic });
-		if (i == indexes.end()) {
-			return;
-		}
+	//Get the iterator to the key
+	unsigned int i = indexes.get( { w, topic });
+	if (i == indexes.end()) {
+		return;
+	}
 
-		//Get the index of the element to be deleted
-		unsigned int index = 0;
-		if (!indexes.getValue(i, index)) {
-			return;
+	//Get the positions of the element to be deleted
+	Position p;
+	if (!indexes.getValue(i, p)) {
+		return;
+	}
+	//Remove from the hash table
+	indexes.remove(i);
+
+	//Remove from the lists and adjust the positions of the replacements
+	auto ws = getSubscribers(topic, false);
+	if (ws) {
+		ws->remove(p.subscriber);
+		ws->shrink(4096);
+		Position *sp = nullptr;
+		auto s = ws->get(p.subscriber);
+		if (s && (sp = getPosition(topic, s->w))) {
+			sp->subscriber = p.subscriber;
 		}
+	}
 
-		//Remove from the list
-		topics[topic].remove(index);
-		topics[topic].shrink(4096);
-		//Remove from the hash table
-		indexes.remove(i);
-
-		//Adjust the index of the replacement
-		const Watcher *s = nullptr;
-		if (!topics[topic].get(s, index)) { //The last entry
-			return;
-		} else {
-			unsigned int tmp;
-			indexes.hmReplace( { s, topic }, index, tmp);
+	auto ts = getSubscriptions(w, false);
+	unsigned int t = 0;
+	if (ts) {
+		ts->remove(p.subscription);
+		Position *tp = nullptr;
+		if (ts->get(t, p.subscription) && (tp = getPosition(t, w))) {
+			tp->subscription = p.subscription;
 		}
 	}
+
+	release(topic, w);
 }
 
 bool Topics::contains(unsigned int topic, const Watcher *w) const noexcept {
-	if ((topic < Topic::COUNT) && w) {
-		unsigned int index = 0;
-		const Watcher *cmp = nullptr;
-
-		//Get the iterator to the key
-		unsigned int i = indexes.get( { w, topic });
-		if (i == indexes.end()) {
-			return false;
-		} else if (!indexes.getValue(i, index)) {
-			return false;
-		} else if (!topics[topic].get(cmp, index)) {
-			return false;
-		} else {
-			return (cmp == w);
-		}
+	return w && indexes.contains( { w, topic });
+}
+
+unsigned int Topics::count(unsigned int topic) const noexcept {
+	Array<Subscriber> *ws = nullptr;
+	if (subscribers.hmGet(topic, ws)) {
+		return ws->readSpace();
 	} else {
-		return false;
+		return 0;
 	}
 }
 
-unsigned int Topics::count(unsigned int topic) const noexcept {
-	if (topic < Topic::COUNT) {
-		return topics[topic].readSpace();
+unsigned int Topics::count(const Watcher *w) const noexcept {
+	Array<unsigned int> *ts = nullptr;
+	if (subscriptions.hmGet(w, ts)) {
+		return ts->readSpace();
 	} else {
 		return 0;
 	}
 }
 
-void Topics::clear() noexcept {
-	for (unsigned int i = 0; i < Topic::COUNT; i++) {
-		topics[i].clear();
+unsigned int Topics::count() const noexcept {
+	return indexes.size();
+}
+
+bool Topics::pop(const Watcher *w, unsigned int &topic) noexcept {
+	auto ts = getSubscriptions(w, false);
+	if (ts && ts->get(topic, ts->readSpace() - 1)) {
+		remove(topic, w);
+		return true;
+	} else {
+		return false;
 	}
+}
 
+void Topics::clear() noexcept {
+	subscribers.iterate(deleteSubscribers, this);
+	subscriptions.iterate(deleteSubscriptions, this);
 	indexes.clear();
 }
 
+Array<Topics::Subscriber>* Topics::getSubscribers(unsigned int topic,
+		bool create) noexcept {
+	Array<Subscriber> *ws = nullptr;
+	if (subscribers.hmGet(topic, ws)) {
+		return ws;
+	} else if (!create) {
+		return nullptr;
+	} else if ((ws = new (std::nothrow) Array<Subscriber>())
+			&& subscribers.hmPut(topic, ws)) {
+		return ws;
+	} else {
+		delete ws;
+		return nullptr;
+	}
+}
+
+Array<unsigned int>* Topics::getSubscriptions(const Watcher *w,
+		bool create) noexcept {
+	Array<unsigned int> *ts = nullptr;
+	if (subscriptions.hmGet(w, ts)) {
+		return ts;
+	} else if (!create) {
+		return nullptr;
+	} else if ((ts = new (std::nothrow) Array<unsigned int>())
+			&& subscriptions.hmPut(w, ts)) {
+		return ts;
+	} else {
+		delete ts;
+		return nullptr;
+	}
+}
+
+void Topics::release(unsigned int topic, const Watcher *w) noexcept {
+	auto ws = getSubscribers(topic, false);
+	if (ws && ws->isEmpty()) {
+		subscribers.removeKey(topic);
+		delete ws;
+	}
+
+	auto ts = getSubscriptions(w, false);
+	if (ts && ts->isEmpty()) {
+		subscriptions.removeKey(w);
+		delete ts;
+	}
+}
+
+Topics::Position* Topics::getPosition(unsigned int topic,
+		const Watcher *w) noexcept {
+	auto i = indexes.get( { w, topic });
+	if (i != indexes.end()) {
+		return indexes.getValueReference(i);
+	} else {
+		return nullptr;
+	}
+}
+
+int Topics::deleteSubscribers(unsigned int index, void *arg) noexcept {
+	Array<Subscriber> *ws = nullptr;
+	((Topics*) arg)->subscribers.getValue(index, ws);
+	delete ws;
+	return 1;
+}
+
+int Topics::deleteSubscriptions(unsigned int index, void *arg) noexcept {
+	Array<unsigned int> *ts = nullptr;
+	((Topics*) arg)->subscriptions.getValue(index, ts);
+	delete ts;
+	return 1;
+}
+
 } /* namespace wanhive */
@@ -15,30 +15,56 @@
 #include "../../base/ds/Array.h"
 #include "../../base/ds/Khash.h"
 #include "../../base/ds/Twiddler.h"
-#include "../../hub/Topic.h"
+#include "../../hub/Conflation.h"
+#include "../../hub/TopicFilter.h"
 #include "../../reactor/Watcher.h"
 
 namespace wanhive {
 /**
  * Subscription manager for overlay hubs
- * Trades off memory for time efficiency
+ * Supports the full 32-bit topic space: the subscriber lists are created on
+ * demand and released as soon as they become empty. Every watcher also keeps
+ * the list of its subscriptions so that it can be removed in O(subscriptions).
+ * A subscription can carry a content filter and the conflation settings.
  * Thread safe at class level
  */
 class Topics {
 public:
+	//A subscriber of a topic
+	struct Subscriber {
+		Watcher *w;
+		TopicFilter filter;
+		Conflation conflation;
+	};
+
 	Topics() noexcept;
 	virtual ~Topics();
-	//Associates the Watcher <w> with the <topic>
-	bool put(unsigned int topic, const Watcher *w) noexcept;
-	//Iterates over the list of Watchers associated with the <topic>
-	Watcher* get(unsigned int topic, unsigned int index) const noexcept;
+	/*
+	 * Associates the Watcher <w> with the <topic>, the subscription's <filter>
+	 * and <conflation> settings are replaced if the Watcher is already
+	 * subscribed to the <topic>.
+	 */
+	bool put(unsigned int topic, Watcher *w, const TopicFilter *filter =
+			nullptr, const Conflation *conflation = nullptr) noexcept;
+	//Iterates over the list of subscribers of the <topic>
+	const Subscriber* get(unsigned int topic,
+			unsigned int index) const noexcept;
 	//Unsubscribes the Watcher <w> from the <topic>
 	void remove(unsigned int topic, const Watcher *w) noexcept;
 	//Returns true if Watcher <w> is subscribed to the <topic>, false otherwise
 	bool contains(unsigned int topic, const Watcher *w) const noexcept;
 	//Returns the number of watchers subscribed to the <topic>
 	unsigned int count(unsigned int topic) const noexcept;
-	//Clears subscriptions without deallocating memory
+	//Returns the number of topics the Watcher <w> is subscribed to
+	unsigned int count(const Watcher *w) const noexcept;
+	//Returns the total number of subscriptions
+	unsigned int count() const noexcept;
+	/*
+	 * Unsubscribes the Watcher <w> from one of its topics and returns that
+	 * topic in <topic>. Returns false if <w> has no subscriptions.
+	 */
+	bool pop(const Watcher *w, unsigned int &topic) noexcept;
+	//Removes all the subscriptions and releases the lists
 	void clear() noexcept;
 private:
 	struct Key {
@@ -46,22 +72,52 @@ private:
 		unsigned int topic;
 	};
 
+	//Position of a subscription in the two lists
+	struct Position {
+		unsigned int subscriber;
+		unsigned int subscription;
+	};
+
 	struct HFN {
 		unsigned int operator()(const Key &key) const noexcept {
 			return (Twiddler::mix((unsigned long long) key.w) + key.topic);
 		}
+
+		unsigned int operator()(const Watcher *w) const noexcept {
+			return Twiddler::mix((unsigned long long) w);
+		}
 	};
 
 	struct EQFN {
 		bool operator()(const Key &k1, const Key &k2) const noexcept {
 			return ((k1.w == k2.w) && (k1.topic == k2.topic));
 		}
+
+		bool operator()(const Watcher *w1, const Watcher *w2) const noexcept {
+			return (w1 == w2);
+		}
 	};
 
-	//List of watchers subscribed to various topics
-	Array<const Watcher*> topics[Topic::COUNT];
+	//Returns the list of subscribers of the <topic>, optionally creates one
+	Array<Subscriber>* getSubscribers(unsigned int topic,
+			bool create) noexcept;
+	//Returns the list of subscriptions of the Watcher <w>, optionally creates one
+	Array<unsigned int>* getSubscriptions(const Watcher *w,
+			bool create) noexcept;
+	//Releases the lists which have become empty
+	void release(unsigned int topic, const Watcher *w) noexcept;
+	//Returns the position of an existing subscription
+	Position* getPosition(unsigned int topic, const Watcher *w) noexcept;
+	//Callbacks for hash table iteration
+	static int deleteSubscribers(unsigned int index, void *arg) noexcept;
+	static int deleteSubscriptions(unsigned int index, void *arg) noexcept;
+
+	//Watchers subscribed to a topic
+	Khash<unsigned int, Array<Subscriber>*> subscribers;
+	//Topics a watcher has subscribed to
+	Khash<const Watcher*, Array<unsigned int>*, true, HFN, EQFN> subscriptions;
 	//Index lookup table for fast insertion and deletion
-	Khash<Key, unsigned int, true, HFN, EQFN> indexes;
+	Khash<Key, Position, true, HFN, EQFN> indexes;
 };
 
 } /* namespace wanhive */
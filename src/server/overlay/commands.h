@@ -40,10 +40,14 @@ enum WhpDhtQualifier {
 	WH_DHT_QLF_GETKEY = WH_QLF_GETKEY,
 	WH_DHT_QLF_FINDROOT = WH_QLF_FINDROOT,
 	WH_DHT_QLF_BOOTSTRAP = WH_QLF_BOOTSTRAP,
+	WH_DHT_QLF_RESUME = WH_QLF_RESUME,
 	//WH_DHT_CMD_MULTICAST
 	WH_DHT_QLF_PUBLISH = WH_QLF_PUBLISH,
 	WH_DHT_QLF_SUBSCRIBE = WH_QLF_SUBSCRIBE,
 	WH_DHT_QLF_UNSUBSCRIBE = WH_QLF_UNSUBSCRIBE,
+	WH_DHT_QLF_XPUBLISH = WH_QLF_XPUBLISH,
+	WH_DHT_QLF_XSUBSCRIBE = WH_QLF_XSUBSCRIBE,
+	WH_DHT_QLF_XUNSUBSCRIBE = WH_QLF_XUNSUBSCRIBE,
 	//WH_DHT_CMD_NODE
 	WH_DHT_QLF_GETPREDECESSOR = 0,
 	WH_DHT_QLF_SETPREDECESSOR = 1,
@@ -53,12 +57,23 @@ enum WhpDhtQualifier {
 	WH_DHT_QLF_SETFINGER = 5,
 	WH_DHT_QLF_GETNEIGHBOURS = 6,
 	WH_DHT_QLF_NOTIFY = 7,
+	WH_DHT_QLF_GETSHORTCUT = 8,
+	WH_DHT_QLF_SETSHORTCUT = 9,
+	WH_DHT_QLF_GETLATENCY = 10,
 	//WH_DHT_CMD_OVERLAY
 	WH_DHT_QLF_FINDSUCCESSOR = 0,
 	WH_DHT_QLF_PING = 1,
 	WH_DHT_QLF_MAP = 2
 };
 
+/*
+ * Functions executed on every hub by the map request.
+ */
+enum WhpDhtMapFunction {
+	WH_DHT_MAP_NULL = 0, //Counts the hubs
+	WH_DHT_MAP_STATISTICS = 1 //Aggregates the resource usage and traffic
+};
+
 /*
  * Request and response status.
  */
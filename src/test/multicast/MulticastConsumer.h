@@ -13,6 +13,7 @@
 #ifndef WH_TEST_MULTICAST_MULTICASTCONSUMER_H_
 #define WH_TEST_MULTICAST_MULTICASTCONSUMER_H_
 #include "../../hub/ClientHub.h"
+#include "../../hub/Topic.h"
 
 namespace wanhive {
 /**
@@ -21,7 +21,8 @@ constexpr unsigned int DEFAULT_ROUNDS = 1;
 namespace wanhive {
 
 Authenticator::Authenticator(bool isHost) noexcept :
-		Srp(SRP_2048, WH_SHA512), id(0), isHost(isHost), authenticated(false) {
+		Srp(SRP_2048, WH_SHA512), id(0), isHost(isHost), authenticated(false), stage(
+				STAGE_NONE) {
 }
 
 Authenticator::~Authenticator() {
@@ -31,23 +32,52 @@ Authenticator::~Authenticator() {
 bool Authenticator::identify(unsigned long long identity,
 		const unsigned char *nonce, unsigned int nonceLength, const char *salt,
 		const char *verifier) noexcept {
+	return prepare(identity, nonce, nonceLength, salt, verifier) && resume();
+}
+
+bool Authenticator::prepare(unsigned long long identity,
+		const unsigned char *nonce, unsigned int nonceLength, const char *salt,
+		const char *verifier) noexcept {
 	if (!isHost) {
 		return false;
 	}
 
+	stage = STAGE_NONE;
 	auto success = initialize() && loadSalt(salt)
-			&& loadPasswordVerifier(verifier) && loadHostSecret()
-			&& loadHostNonce() && loadUserNonce(nonce, nonceLength)
+			&& loadPasswordVerifier(verifier)
+			&& loadUserNonce(nonce, nonceLength);
+
+	if (success) {
+		this->id = identity;
+		stage = STAGE_PREPARED;
+	}
+
+	return success;
+}
+
+bool Authenticator::resume() noexcept {
+	if (stage != STAGE_PREPARED) {
+		return false;
+	}
+
+	auto success = loadHostSecret() && loadHostNonce()
 			&& loadRandomScramblingParameter() && loadSessionKey(true)
 			&& generateUserEvidence() && generateHostEvidence();
 
 	if (success) {
-		this->id = identity;
+		stage = STAGE_IDENTIFIED;
+	} else {
+		this->id = 0;
+		stage = STAGE_NONE;
 	}
 
 	return success;
 }
 
+bool Authenticator::isPending() const noexcept {
+	return stage == STAGE_PREPARED;
+}
+
 bool Authenticator::createIdentity(unsigned long long identity,
 		const unsigned char *password, unsigned int passwordLength,
 		const unsigned char *salt, unsigned int saltLength,
@@ -80,7 +110,8 @@ bool Authenticator::createIdentity(unsigned long long identity,
 
 bool Authenticator::authenticateUser(const unsigned char *proof,
 		unsigned int length) noexcept {
-	if (!isHost || !proof || !length || (length != keySize())) {
+	if (!isHost || stage != STAGE_IDENTIFIED || !proof || !length
+			|| (length != keySize())) {
 		return false;
 	} else if (verifyUserProof(proof, length)) {
 		authenticated = true;
@@ -154,6 +185,14 @@ bool Authenticator::generateVerifier(const char *identity,
 			&& loadPasswordVerifier();
 }
 
+void Authenticator::reset() noexcept {
+	Srp::reset();
+	State::clear();
+	id = 0;
+	authenticated = false;
+	stage = STAGE_NONE;
+}
+
 void Authenticator::generateFakeNonce(const unsigned char *&binary,
 		unsigned int &bytes) noexcept {
 	if (initialize() && Srp::generateFakeNonce()) {
@@ -37,6 +37,18 @@ public:
 	bool identify(unsigned long long identity, const unsigned char *nonce,
 			unsigned int nonceLength, const char *salt,
 			const char *verifier) noexcept;
+	/*
+	 * Host: STEP 1 in two stages, <prepare> loads I, A, s and v (inexpensive)
+	 * and <resume> completes the remaining computations (expensive). The
+	 * latter may run in a different thread, the object must not be accessed
+	 * by anyone else until it returns.
+	 */
+	bool prepare(unsigned long long identity, const unsigned char *nonce,
+			unsigned int nonceLength, const char *salt,
+			const char *verifier) noexcept;
+	bool resume() noexcept;
+	//Host: returns true if STEP 1 has been prepared but not resumed
+	bool isPending() const noexcept;
 	/*
 	 * STEP 2: Host -> User:  s, B = kv + g^b (sends salt and nonce, b = random number)
 	 * User:  u = H(A, B)
@@ -120,10 +132,21 @@ public:
 	 */
 	void generateFakeSalt(unsigned long long identity, const unsigned char *&s,
 			unsigned int &sLength) noexcept;
+	/*
+	 * General: securely wipes the session's state for reuse of this object,
+	 * the allocated memory is retained.
+	 */
+	void reset() noexcept;
 private:
+	//Progress of the STEP 1 at host
+	enum Stage : unsigned char {
+		STAGE_NONE, STAGE_PREPARED, STAGE_IDENTIFIED
+	};
+
 	unsigned long long id;
 	bool isHost;
 	bool authenticated;
+	Stage stage;
 };
 
 } /* namespace wanhive */
@@ -17,7 +17,7 @@
 namespace wanhive {
 MemoryPool Message::pool;
 Message::Message(uint64_t origin) noexcept :
-		referenceCount(0), ttl(0), origin(origin) {
+		referenceCount(0), ttl(0), timestamp(0), origin(origin) {
 
 }
 
@@ -73,6 +73,7 @@ void Message::recycle(Message *p) noexcept {
 void Message::clear() noexcept {
 	referenceCount = 0;
 	ttl = 0;
+	timestamp = 0;
 
 	State::clear();
 	header.clear();
@@ -92,6 +93,14 @@ unsigned int Message::addTTL() noexcept {
 	return ++ttl;
 }
 
+void Message::setTimestamp(unsigned long long timestamp) noexcept {
+	this->timestamp = timestamp;
+}
+
+unsigned long long Message::getTimestamp() const noexcept {
+	return timestamp;
+}
+
 uint64_t Message::getOrigin() const noexcept {
 	return origin;
 }
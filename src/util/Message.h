@@ -66,6 +66,14 @@ public:
 	unsigned int addReferenceCount() noexcept;
 	//Increases and returns the ttl count
 	unsigned int addTTL() noexcept;
+	/*
+	 * Records the time (in milliseconds) of insertion into the hub's queue.
+	 * The shared messages can sit in several sockets' queues, those queues
+	 * keep their own time stamps.
+	 */
+	void setTimestamp(unsigned long long timestamp) noexcept;
+	//Returns the time (in milliseconds) of insertion into the hub's queue
+	unsigned long long getTimestamp() const noexcept;
 	//Returns the local source identifier
 	uint64_t getOrigin() const noexcept;
 	//=================================================================
@@ -266,6 +274,7 @@ public:
 private:
 	unsigned int referenceCount; //Reference count
 	unsigned int ttl; //TTL up-counter
+	unsigned long long timestamp; //Queueing time
 
 	const uint64_t origin; //The local source
 	MessageHeader header; //The routing header
@@ -11,12 +11,34 @@
  */
 
 #include "PKI.h"
+#include "../base/common/Atomic.h"
 #include "../base/common/Exception.h"
 #include "../base/security/CryptoUtils.h"
+#include "../base/security/Sha.h"
+#include <cstring>
+
+namespace {
+
+//Result of a recent signature verification
+struct Verification {
+	//Identifies the public key, 0 if the slot is empty
+	unsigned long long serial;
+	//SHA-256 digest of the signed block followed by the signature
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	bool verdict;
+};
+
+//Direct mapped, per-thread cache of the verification results
+thread_local Verification verifications[wanhive::PKI::VERIFY_CACHE_SIZE];
+//Source of the public key serial numbers
+unsigned long long serials = 0;
+
+}  // namespace
 
 namespace wanhive {
 
-PKI::PKI() noexcept {
+PKI::PKI() noexcept :
+		serial(0) {
 
 }
 
@@ -26,10 +48,12 @@ PKI::~PKI() {
 
 bool PKI::initialize(const char *hostKey, const char *publicKey,
 		bool fromFile) noexcept {
+	renew();
 	return rsa.init(hostKey, publicKey, fromFile, nullptr);
 }
 
 bool PKI::loadPublicKey(const char *publicKey, bool fromFile) noexcept {
+	renew();
 	return rsa.loadPublicKey(publicKey, fromFile) || !publicKey;
 }
 
@@ -74,8 +98,32 @@ bool PKI::sign(const void *block, unsigned int size,
 
 bool PKI::verify(const void *block, unsigned int len,
 		const Signature *sig) const noexcept {
-	return rsa.verify((unsigned char*) block, len, (unsigned char*) sig,
+	//A retransmission costs a digest and a lookup instead of the RSA operation
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	Sha sha(WH_SHA256);
+	if (!serial || !block || !sig || !sha.init() || !sha.update(block, len)
+			|| !sha.update(sig, SIGNATURE_LENGTH) || !sha.final(digest)) {
+		return rsa.verify((unsigned char*) block, len, (unsigned char*) sig,
+				SIGNATURE_LENGTH);
+	}
+
+	unsigned int index;
+	memcpy(&index, digest, sizeof(index));
+	auto &entry = verifications[index & (VERIFY_CACHE_SIZE - 1)];
+	if (entry.serial == serial && !memcmp(entry.digest, digest, sizeof(digest))) {
+		return entry.verdict;
+	}
+
+	auto verdict = rsa.verify((unsigned char*) block, len, (unsigned char*) sig,
 			SIGNATURE_LENGTH);
+	entry.serial = serial;
+	memcpy(entry.digest, digest, sizeof(digest));
+	entry.verdict = verdict;
+	return verdict;
+}
+
+void PKI::renew() noexcept {
+	serial = Atomic<unsigned long long>::addAndFetch(&serials, 1);
 }
 
 void PKI::generateKeyPair(const char *hostKey, const char *publicKey) {
@@ -59,6 +59,7 @@ public:
 
 	bool sign(const void *block, unsigned int size,
 			Signature *sig) const noexcept;
+	//Results are cached, repeated verification of a signed block is cheap
 	bool verify(const void *block, unsigned int len,
 			const Signature *sig) const noexcept;
 	//=================================================================
@@ -75,8 +76,15 @@ public:
 	//Maximum size in bytes of the plain text block which can be encrypted
 	static constexpr unsigned int MAX_PT_LEN = (ENCODING_LENGTH)
 			- ((2 * 160 / 8) + 2);
+	//Number of the cached verification results per thread (power of 2)
+	static constexpr unsigned int VERIFY_CACHE_SIZE = 64;
+private:
+	//Invalidates the cached verification results of this object
+	void renew() noexcept;
 private:
 	Rsa rsa;
+	//Identifies the public key in the verification cache (0: uncached)
+	unsigned long long serial;
 };
 
 #undef WH_PKI_KEY_LENGTH
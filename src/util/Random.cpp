@@ -25,7 +25,7 @@ Random::~Random() {
 }
 
 void Random::bytes(void *block, unsigned int count) {
-	if (!CSPRNG::bytes(block, count)) {
+	if (!CSPRNG::buffered(block, count)) {
 		throw Exception(EX_SECURITY);
 	}
 }
@@ -32,10 +32,15 @@ enum WhpQualifier {
 	WH_QLF_GETKEY = 1,
 	WH_QLF_FINDROOT = 2,
 	WH_QLF_BOOTSTRAP = 3,
+	WH_QLF_RESUME = 4,
 	//WH_CMD_MULTICAST
 	WH_QLF_PUBLISH = 0,
 	WH_QLF_SUBSCRIBE = 1,
-	WH_QLF_UNSUBSCRIBE = 2
+	WH_QLF_UNSUBSCRIBE = 2,
+	//Extended topics: 32-bit topic in the first 4 bytes of the payload
+	WH_QLF_XPUBLISH = 3,
+	WH_QLF_XSUBSCRIBE = 4,
+	WH_QLF_XUNSUBSCRIBE = 5
 };
 
 enum WhpStatus {